@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../stl_algorithm.hpp"
+#include "../stl_function.hpp"
+#include "../stl_vector.hpp"
+#include "bench_util.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+const char* level_names[] = { "scalar", "sse2  ", "avx2  " };
+
+// the bytes scanned per nanosecond at each level, the scan answers a size_t
+template <typename T, typename Scan>
+void scan_benchmark(const char* name, const vector<T>& values, Scan scan) {
+	const size_t total = 200000000 / sizeof(T);
+	const size_t rounds = total / values.size() + 1;
+	cout << "  " << name;
+	double scalar = 0;
+	for (int level = simd_scalar; level <= simd_dispatch::hardware_level(); ++level) {
+		simd_dispatch::__set_level(level);
+		double time = seconds_of([&]() {
+			for (size_t r = 0; r < rounds; ++r) {
+				sink = sink + scan(values);
+			}
+		});
+		double bytes_per_ns = double(rounds * values.size() * sizeof(T)) / (time * 1e9);
+		if (level == simd_scalar)
+			scalar = time;
+		cout << level_names[level] << ' ' << bytes_per_ns << " GB/s (" << scalar / time << "x)  ";
+	}
+	simd_dispatch::__set_level(simd_avx2);
+	cout << "\n";
+}
+
+// every scan goes through the whole range, the value looked for is not there
+// and the two ranges of mismatch and equal are the same
+template <typename T>
+void scans(const char* type, size_t n) {
+	vector<T> values(n);
+	for (size_t i = 0; i < n; ++i) {
+		values[i] = T(i % 97 + 1);
+	}
+	const vector<T> copy = values;
+	cout << type << ", " << n << " elements\n";
+	scan_benchmark("find          ", values, [](const vector<T>& v) {
+		return size_t(find(v.begin(), v.end(), T(0)) - v.begin());
+	});
+	scan_benchmark("count         ", values, [](const vector<T>& v) {
+		return size_t(count(v.begin(), v.end(), T(5)));
+	});
+	scan_benchmark("count_if      ", values, [](const vector<T>& v) {
+		return size_t(count_if(v.begin(), v.end(), bind2nd(less<T>(), T(50))));
+	});
+	scan_benchmark("mismatch      ", values, [&copy](const vector<T>& v) {
+		return size_t(mismatch(v.begin(), v.end(), copy.begin()).first - v.begin());
+	});
+	scan_benchmark("equal         ", values, [&copy](const vector<T>& v) {
+		return size_t(equal(v.begin(), v.end(), copy.begin()));
+	});
+	scan_benchmark("adjacent_find ", values, [](const vector<T>& v) {
+		return size_t(adjacent_find(v.begin(), v.end()) - v.begin());
+	});
+}
+
+// the values wander up and down, the extremes are in the middle of the range
+template <typename T>
+void extremes(const char* type, size_t n) {
+	vector<T> values(n);
+	for (size_t i = 0; i < n; ++i) {
+		values[i] = T(i % 89 + i % 7);
+	}
+	values[n / 2] = T(0);
+	values[n / 3] = T(120);
+	cout << type << ", " << n << " elements\n";
+	scan_benchmark("min_element    ", values, [](const vector<T>& v) {
+		return size_t(min_element(v.begin(), v.end()) - v.begin());
+	});
+	scan_benchmark("max_element    ", values, [](const vector<T>& v) {
+		return size_t(max_element(v.begin(), v.end()) - v.begin());
+	});
+	scan_benchmark("min + max      ", values, [](const vector<T>& v) {
+		return size_t(min_element(v.begin(), v.end()) - v.begin()) + size_t(max_element(v.begin(), v.end()) - v.begin());
+	});
+	scan_benchmark("minmax_element ", values, [](const vector<T>& v) {
+		pair<typename vector<T>::const_iterator, typename vector<T>::const_iterator> both =
+			minmax_element(v.begin(), v.end());
+		return size_t(both.first - v.begin()) + size_t(both.second - v.begin());
+	});
+	scan_benchmark("minmax by less ", values, [](const vector<T>& v) {
+		pair<typename vector<T>::const_iterator, typename vector<T>::const_iterator> both =
+			minmax_element(v.begin(), v.end(), less<T>());
+		return size_t(both.first - v.begin()) + size_t(both.second - v.begin());
+	});
+}
+
+int main(int argc, char** argv) {
+	// 16K elements stay in the cache, 4M do not
+	size_t small = 16384;
+	size_t large = argc > 1 ? std::strtoull(argv[1], 0, 10) : 4194304;
+
+	cout << "----- SIMD scans -----\n";
+	scans<int32_t>("int32_t", small);
+	scans<int32_t>("int32_t", large);
+	scans<uint8_t>("uint8_t", small);
+	scans<uint8_t>("uint8_t", large);
+	cout << endl;
+
+	cout << "----- SIMD min and max -----\n";
+	extremes<int32_t>("int32_t", small);
+	extremes<int32_t>("int32_t", large);
+	extremes<uint8_t>("uint8_t", small);
+	extremes<float>("float", small);
+	extremes<double>("double", large);
+	cout << endl;
+
+	return 0;
+}
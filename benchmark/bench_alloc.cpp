@@ -0,0 +1,251 @@
+#include <iostream>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../stl_alloc.hpp"
+#include "../stl_deque.hpp"
+#include "../stl_list.hpp"
+#include "../stl_vector.hpp"
+#include "bench_util.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+// allocate and free blocks of every size class in rounds,
+// return the number of operations per second over all threads
+template <typename Alloc>
+double alloc_throughput(size_t thread_num, size_t rounds) {
+	const size_t batch = 256;
+	auto work = [&]() {
+		void* ptrs[batch];
+		for (size_t r = 0; r < rounds; ++r) {
+			for (size_t i = 0; i < batch; ++i) {
+				ptrs[i] = Alloc::allocate((i % 16 + 1) * 8);
+			}
+			for (size_t i = 0; i < batch; ++i) {
+				Alloc::deallocate(ptrs[i], (i % 16 + 1) * 8);
+			}
+		}
+	};
+
+	double seconds = seconds_of([&]() {
+		std::vector<std::thread> pool;
+		for (size_t t = 0; t < thread_num; ++t) {
+			pool.emplace_back(work);
+		}
+		for (auto& t : pool) {
+			t.join();
+		}
+	});
+	return 2.0 * batch * rounds * thread_num / seconds;
+}
+
+struct record {
+	char bytes[192];
+};
+
+// build and tear down a list of 32 bytes nodes and a deque of 192 bytes records
+template <typename Alloc>
+void layout_workload(const char* name, size_t n) {
+	double list_time = seconds_of([n]() {
+		for (int r = 0; r < 5; ++r) {
+			selfmadeSTL::list<std::pair<uint64_t, uint64_t>, Alloc> l;
+			for (size_t i = 0; i < n; ++i) {
+				l.push_back(std::make_pair(i, i));
+			}
+			while (!l.empty()) {
+				l.pop_front();
+			}
+		}
+	});
+	double deque_time = seconds_of([n]() {
+		for (int r = 0; r < 5; ++r) {
+			selfmadeSTL::deque<record, Alloc> d;
+			for (size_t i = 0; i < n / 8; ++i) {
+				d.push_back(record());
+			}
+			while (!d.empty()) {
+				d.pop_front();
+			}
+		}
+	});
+	cout << name << ": list " << list_time * 1e3 << " ms, deque " << deque_time * 1e3 << " ms, "
+		<< "heap " << Alloc::stats().heap_size << " bytes\n";
+}
+
+// short lived containers of one request
+template <typename Alloc>
+void request_workload() {
+	selfmadeSTL::vector<int, Alloc> v;
+	for (int i = 0; i < 100; ++i) {
+		v.push_back(i);
+	}
+	selfmadeSTL::list<int, Alloc> l;
+	for (int i = 0; i < 100; ++i) {
+		l.push_back(i);
+	}
+	selfmadeSTL::deque<int, Alloc> d;
+	for (int i = 0; i < 100; ++i) {
+		d.push_back(i);
+	}
+}
+
+template <typename Alloc>
+void end_request() {}
+
+template <>
+void end_request<arena_alloc>() {
+	arena_alloc::reset();
+}
+
+template <typename Alloc>
+void request_benchmark(const char* name, size_t requests) {
+	double time = seconds_of([requests]() {
+		for (size_t r = 0; r < requests; ++r) {
+			request_workload<Alloc>();
+			end_request<Alloc>();
+		}
+	});
+	cout << name << ": " << time * 1e9 / requests << " ns per request\n";
+}
+
+// dTLB load misses of this thread, by perf_event_open
+// read() returns -1 if the counter is not available
+class dtlb_counter {
+private:
+	int fd;
+
+public:
+	dtlb_counter() : fd(-1) {
+#ifdef __linux__
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB |
+			(PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+	~dtlb_counter() {
+#ifdef __linux__
+		if (fd != -1) {
+			close(fd);
+		}
+#endif
+	}
+
+	void start() {
+#ifdef __linux__
+		if (fd != -1) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+	long long read() {
+		long long count = -1;
+#ifdef __linux__
+		if (fd != -1) {
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (::read(fd, &count, sizeof(count)) != sizeof(count)) {
+				count = -1;
+			}
+		}
+#endif
+		return count;
+	}
+};
+
+// build a list of n random keys and sort it, so that the next node is
+// anywhere in the pool, then walk it and count the dTLB misses
+template <typename Alloc>
+void tlb_workload(const char* name, size_t n) {
+	list<uint64_t, Alloc> keys;
+	uint64_t x = 88172645463325252ull;
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		keys.push_back(x);
+	}
+	keys.sort();
+
+	const int walks = 3;
+	uint64_t sum = 0;
+	dtlb_counter counter;
+	counter.start();
+	double walk_time = seconds_of([&]() {
+		for (int w = 0; w < walks; ++w) {
+			for (auto it = keys.begin(); it != keys.end(); ++it) {
+				sum += *it;
+			}
+		}
+	});
+	long long misses = counter.read();
+
+	cout << name << ": walk " << walk_time / walks * 1e3 << " ms, dTLB misses ";
+	if (misses >= 0) {
+		cout << misses / walks;
+	}
+	else {
+		cout << "n/a";
+	}
+	cout << " (" << (sum & 1) << ")\n";
+
+	keys.clear();
+	Alloc::trim();
+}
+
+int main(int argc, char* argv[]) {
+	const size_t rounds = 20000;
+	size_t max_threads = std::thread::hardware_concurrency();
+	if (max_threads == 0) {
+		max_threads = 1;
+	}
+
+	cout << "----- Allocation throughput (Mops/s) -----\n";
+	cout << "single thread alloc: " << alloc_throughput<alloc>(1, rounds) / 1e6 << "\n";
+	cout << "malloc_alloc:        " << alloc_throughput<malloc_alloc>(1, rounds) / 1e6 << "\n";
+	for (size_t n = 1; n <= max_threads; n *= 2) {
+		cout << "thread_alloc, " << n << " threads: "
+			<< alloc_throughput<thread_alloc>(n, rounds) / 1e6 << "\n";
+	}
+	cout << endl;
+
+	const size_t node_num = 1000000;
+	cout << "----- Size class layouts -----\n";
+	layout_workload<__default_alloc_template<false, 10>>("uniform 8 / 128      ", node_num);
+	layout_workload<__default_alloc_template<false, 11, uniform_size_class<16, 512>>>("uniform 16 / 512     ", node_num);
+	layout_workload<__default_alloc_template<false, 12, geometric_size_class<512>>>("geometric 512        ", node_num);
+	layout_workload<__default_alloc_template<false, 13, geometric_size_class<512, 64>>>("geometric 512, 64 obj", node_num);
+	cout << endl;
+
+	const size_t requests = 100000;
+	cout << "----- Short lived containers -----\n";
+	request_benchmark<alloc>("alloc       ", requests);
+	request_benchmark<malloc_alloc>("malloc_alloc", requests);
+	request_benchmark<arena_alloc>("arena_alloc ", requests);
+	cout << endl;
+
+	// nodes of the list walk, 10M by default
+	const size_t walk_nodes = argc > 1 ? (size_t)std::atoll(argv[1]) : 10000000;
+	cout << "----- List walk, " << walk_nodes << " nodes -----\n";
+	tlb_workload<__default_alloc_template<false, 20, default_size_class, malloc_backend>>("malloc chunks   ", walk_nodes);
+	tlb_workload<__default_alloc_template<false, 21, default_size_class, hugepage_backend>>("huge page chunks", walk_nodes);
+	cout << endl;
+
+	return 0;
+}
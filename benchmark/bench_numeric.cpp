@@ -0,0 +1,89 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../stl_function.hpp"
+#include "../stl_numeric.hpp"
+#include "../stl_vector.hpp"
+#include "bench_util.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+const char* level_names[] = { "scalar", "sse2  ", "avx2  " };
+
+// the bytes read per nanosecond at each level, the scalar level is the loop
+// one element at a time that the algorithm ran before it had the kernels
+template <typename T, typename Run>
+void numeric_benchmark(const char* name, const vector<T>& values, size_t ranges, Run run) {
+	const size_t total = 200000000 / sizeof(T);
+	const size_t rounds = total / values.size() + 1;
+	cout << "  " << name;
+	double scalar = 0;
+	for (int level = simd_scalar; level <= simd_dispatch::hardware_level(); ++level) {
+		simd_dispatch::__set_level(level);
+		double time = seconds_of([&]() {
+			for (size_t r = 0; r < rounds; ++r) {
+				sink = sink + double(run(values));
+			}
+		});
+		double bytes_per_ns = double(rounds * values.size() * sizeof(T) * ranges) / (time * 1e9);
+		if (level == simd_scalar)
+			scalar = time;
+		cout << level_names[level] << ' ' << bytes_per_ns << " GB/s (" << scalar / time << "x)  ";
+	}
+	simd_dispatch::__set_level(simd_avx2);
+	cout << "\n";
+}
+
+// integers take the kernels as they are, floating point values only with unseq,
+// the lines without it show that their loop is left as it was
+template <typename T>
+void numerics(const char* type, size_t n) {
+	vector<T> values(n);
+	vector<T> weights(n);
+	for (size_t i = 0; i < n; ++i) {
+		values[i] = T(i % 97 + 1);
+		weights[i] = T(i % 5 + 1);
+	}
+	vector<T> sums(n);
+	cout << type << ", " << n << " elements\n";
+	numeric_benchmark("accumulate          ", values, 1, [](const vector<T>& v) {
+		return accumulate(v.begin(), v.end(), T(0));
+	});
+	numeric_benchmark("accumulate unseq    ", values, 1, [](const vector<T>& v) {
+		return accumulate(unseq, v.begin(), v.end(), T(0));
+	});
+	numeric_benchmark("inner_product       ", values, 2, [&weights](const vector<T>& v) {
+		return inner_product(v.begin(), v.end(), weights.begin(), T(0));
+	});
+	numeric_benchmark("inner_product unseq ", values, 2, [&weights](const vector<T>& v) {
+		return inner_product(unseq, v.begin(), v.end(), weights.begin(), T(0));
+	});
+	numeric_benchmark("partial_sum         ", values, 2, [&sums](const vector<T>& v) {
+		partial_sum(v.begin(), v.end(), sums.begin());
+		return sums[sums.size() / 2];
+	});
+	numeric_benchmark("partial_sum unseq   ", values, 2, [&sums](const vector<T>& v) {
+		partial_sum(unseq, v.begin(), v.end(), sums.begin());
+		return sums[sums.size() / 2];
+	});
+}
+
+int main(int argc, char** argv) {
+	// 16K elements stay in the cache, 4M do not
+	size_t small = 16384;
+	size_t large = argc > 1 ? std::strtoull(argv[1], 0, 10) : 4194304;
+
+	cout << "----- SIMD accumulate, inner_product and partial_sum -----\n";
+	numerics<int>("int", small);
+	numerics<int>("int", large);
+	numerics<float>("float", small);
+	numerics<float>("float", large);
+	numerics<double>("double", small);
+	numerics<double>("double", large);
+	cout << endl;
+
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <string>
+
+#include "../stl_small_vector.hpp"
+#include "bench_util.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+// counts the heap allocations of alloc
+struct counting_alloc {
+	static size_t allocations;
+
+	static void* allocate(size_t n) {
+		++allocations;
+		return alloc::allocate(n);
+	}
+	static void deallocate(void* ptr, size_t n) {
+		alloc::deallocate(ptr, n);
+	}
+	static void* reallocate(void* ptr, size_t old_size, size_t new_size) {
+		++allocations;
+		return alloc::reallocate(ptr, old_size, new_size);
+	}
+};
+size_t counting_alloc::allocations = 0;
+
+// a short-lived container per request, filled with 1 to max_size elements
+template <typename Container, typename T>
+void request_benchmark(const char* name, size_t requests, size_t max_size, const T& value) {
+	counting_alloc::allocations = 0;
+	size_t total = 0;
+	double time = seconds_of([&]() {
+		for (size_t r = 0; r < requests; ++r) {
+			Container c;
+			size_t n = r % max_size + 1;
+			for (size_t i = 0; i < n; ++i) {
+				c.push_back(value);
+			}
+			total += c.size();
+		}
+	});
+	cout << name << ": " << counting_alloc::allocations << " allocations, "
+		<< time * 1e9 / requests << " ns per request\n";
+	sink = sink + total;
+}
+
+template <typename T>
+void size_benchmark(const char* name, size_t max_size, const T& value) {
+	const size_t requests = 1000000;
+	cout << name << ", 1.." << max_size << " elements\n";
+	request_benchmark<vector<T, counting_alloc>>("  vector         ", requests, max_size, value);
+	request_benchmark<small_vector<T, 8, counting_alloc>>("  small_vector<8>", requests, max_size, value);
+}
+
+int main() {
+	cout << "----- Short-lived vectors -----\n";
+	size_benchmark("int", 4, 1);
+	size_benchmark("int", 8, 1);
+	size_benchmark("int", 32, 1);
+	size_benchmark("string", 8, std::string("short"));
+	cout << endl;
+
+	return 0;
+}
@@ -0,0 +1,251 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include "../stl_parallel.hpp"
+#include "../stl_vector.hpp"
+#include "bench_util.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+vector<uint64_t> random_keys(size_t n) {
+	std::mt19937_64 rng(2024);
+	vector<uint64_t> keys;
+	keys.resize_for_overwrite(n);
+	for (size_t i = 0; i < n; ++i) {
+		keys[i] = rng();
+	}
+	return keys;
+}
+
+// the comparison sort that sort() runs when it does not turn into radix sort
+template <typename T>
+void introsort(vector<T>& v) {
+	__introsort_loop(v.begin(), v.end(), (T*)0, __log2(v.end() - v.begin()));
+}
+
+// the best of repeats sorts of the same keys
+template <typename T, typename Sort>
+double sort_time(const vector<T>& keys, int repeats, Sort sort_keys) {
+	double best = 1e9;
+	for (int r = 0; r < repeats; ++r) {
+		vector<T> v = keys;
+		double time = seconds_of([&]() { sort_keys(v); });
+		if (time < best)
+			best = time;
+		sink = sink + (uint64_t)(v.size() / 2);
+	}
+	return best;
+}
+
+// the speedup of the parallel sort over the sequential one, 1 to 64 threads
+void scaling_benchmark(size_t n, int repeats) {
+	vector<uint64_t> keys = random_keys(n);
+	cout << n << " uint64_t, " << std::thread::hardware_concurrency() << " hardware threads\n";
+	double sequential = sort_time(keys, repeats, [](vector<uint64_t>& v) { introsort(v); });
+	cout << "  sequential : " << sequential * 1e3 << " ms\n";
+	for (size_t threads = 1; threads <= 64; threads *= 2) {
+		double time = sort_time(keys, repeats, [threads](vector<uint64_t>& v) {
+			sort(parallel_policy(threads), v.begin(), v.end());
+		});
+		cout << "  " << threads << (threads < 10 ? " " : "") << " threads : " << time * 1e3 << " ms, speedup "
+			<< sequential / time << "\n";
+	}
+}
+
+template <typename T, typename Make>
+void radix_benchmark(const char* name, size_t n, int repeats, Make make) {
+	std::mt19937_64 rng(7);
+	vector<T> keys;
+	for (size_t i = 0; i < n; ++i) {
+		keys.push_back(make(rng));
+	}
+	double comparison = sort_time(keys, repeats, [](vector<T>& v) { introsort(v); });
+	double radix = sort_time(keys, repeats, [](vector<T>& v) { radix_sort(v.begin(), v.end()); });
+	cout << "  " << name << n << ": introsort " << comparison * 1e3 << " ms, radix_sort " << radix * 1e3
+		<< " ms, speedup " << comparison / radix << "\n";
+}
+
+struct record {
+	uint64_t id;
+	double score;
+	char payload[16];
+};
+
+void record_benchmark(size_t n, int repeats) {
+	std::mt19937_64 rng(11);
+	vector<record> records;
+	for (size_t i = 0; i < n; ++i) {
+		record r = { i, double(int64_t(rng() % 2000000) - 1000000) * 0.5, {} };
+		records.push_back(r);
+	}
+	double comparison = sort_time(records, repeats, [](vector<record>& v) {
+		sort(v.begin(), v.end(), [](const record& a, const record& b) { return a.score < b.score; });
+	});
+	double radix = sort_time(records, repeats, [](vector<record>& v) {
+		radix_sort(v.begin(), v.end(), [](const record& r) { return r.score; });
+	});
+	cout << "  record by double " << n << ": sort " << comparison * 1e3 << " ms, radix_sort " << radix * 1e3
+		<< " ms, speedup " << comparison / radix << "\n";
+}
+
+// sort and nth_element with a comparator, so that sort() does not turn into radix sort
+template <typename Make>
+void pattern_benchmark(const char* name, size_t n, int repeats, Make make) {
+	vector<int> keys(n);
+	for (size_t i = 0; i < n; ++i) {
+		keys[i] = make(i);
+	}
+	auto comp = [](int a, int b) { return a < b; };
+	double sort_ms = sort_time(keys, repeats, [comp](vector<int>& v) { sort(v.begin(), v.end(), comp); }) * 1e3;
+	double nth_ms = sort_time(keys, repeats, [comp](vector<int>& v) {
+		nth_element(v.begin(), v.begin() + v.size() / 3, v.end(), comp);
+	}) * 1e3;
+	cout << "  " << name << ": sort " << sort_ms << " ms, nth_element " << nth_ms << " ms\n";
+}
+
+// merge_sort as it was before inplace_merge got a buffer
+template <typename T>
+void bufferless_merge_sort(vector<T>& v, ptrdiff_t first, ptrdiff_t last) {
+	if (last - first < 2)
+		return;
+	ptrdiff_t middle = first + (last - first) / 2;
+	bufferless_merge_sort(v, first, middle);
+	bufferless_merge_sort(v, middle, last);
+	__merge_without_buffer(v.begin() + first, v.begin() + middle, v.begin() + last, middle - first, last - middle,
+		less<T>());
+}
+
+void stable_benchmark(size_t n, int repeats) {
+	std::mt19937_64 rng(13);
+	vector<record> records;
+	for (size_t i = 0; i < n; ++i) {
+		record r = { i, double(rng() % 1000), {} };
+		records.push_back(r);
+	}
+	auto score_less = [](const record& a, const record& b) { return a.score < b.score; };
+	double stable = sort_time(records, repeats, [score_less](vector<record>& v) {
+		stable_sort(v.begin(), v.end(), score_less);
+	});
+	double merge = sort_time(records, repeats, [score_less](vector<record>& v) {
+		merge_sort(v.begin(), v.end(), score_less);
+	});
+	vector<uint64_t> keys = random_keys(n);
+	double stable_keys = sort_time(keys, repeats, [](vector<uint64_t>& v) { stable_sort(v.begin(), v.end()); });
+	double merge_keys = sort_time(keys, repeats, [](vector<uint64_t>& v) { merge_sort(v.begin(), v.end()); });
+	double bufferless_keys = sort_time(keys, repeats, [](vector<uint64_t>& v) {
+		bufferless_merge_sort(v, 0, v.end() - v.begin());
+	});
+	cout << "  record " << n << ": stable_sort " << stable * 1e3 << " ms, merge_sort " << merge * 1e3 << " ms\n";
+	cout << "  uint64_t " << n << ": stable_sort " << stable_keys * 1e3 << " ms, merge_sort " << merge_keys * 1e3
+		<< " ms, merge_sort without buffer " << bufferless_keys * 1e3 << " ms, speedup "
+		<< bufferless_keys / stable_keys << "\n";
+}
+
+// an entry of an event log, sorted by key in the order the entries came
+struct log_event {
+	uint64_t key;
+	uint64_t id;
+};
+
+struct key_less {
+	bool operator()(const log_event& a, const log_event& b) const { return a.key < b.key; }
+};
+
+// the speedup of the parallel stable_sort and merge over the sequential ones, 1 to 64 threads
+void stable_scaling_benchmark(size_t n, int repeats) {
+	std::mt19937_64 rng(17);
+	vector<log_event> events;
+	events.resize_for_overwrite(n);
+	for (size_t i = 0; i < n; ++i) {
+		// about 16 events for each key
+		events[i].key = rng() % (n / 16 + 1);
+		events[i].id = i;
+	}
+	cout << n << " log_event, " << std::thread::hardware_concurrency() << " hardware threads\n";
+	double sequential = sort_time(events, repeats, [](vector<log_event>& v) {
+		stable_sort(v.begin(), v.end(), key_less());
+	});
+	cout << "  stable_sort sequential : " << sequential * 1e3 << " ms\n";
+	for (size_t threads = 1; threads <= 64; threads *= 2) {
+		double time = sort_time(events, repeats, [threads](vector<log_event>& v) {
+			stable_sort(parallel_policy(threads), v.begin(), v.end(), key_less());
+		});
+		cout << "  stable_sort " << threads << (threads < 10 ? " " : "") << " threads : " << time * 1e3
+			<< " ms, speedup " << sequential / time << "\n";
+	}
+
+	// the two halves sorted, merged into another vector
+	vector<log_event>::iterator middle = events.begin() + n / 2;
+	stable_sort(events.begin(), middle, key_less());
+	stable_sort(middle, events.end(), key_less());
+	vector<log_event> merged;
+	merged.resize_for_overwrite(n);
+	// the first merge faults the pages of merged in, it is not timed
+	merge(events.begin(), middle, middle, events.end(), merged.begin(), key_less());
+	sequential = 1e9;
+	for (int r = 0; r < repeats; ++r) {
+		sequential = min(sequential, seconds_of([&]() {
+			merge(events.begin(), middle, middle, events.end(), merged.begin(), key_less());
+		}));
+	}
+	cout << "  merge sequential : " << sequential * 1e3 << " ms\n";
+	for (size_t threads = 1; threads <= 64; threads *= 2) {
+		double time = 1e9;
+		for (int r = 0; r < repeats; ++r) {
+			time = min(time, seconds_of([&]() {
+				merge(parallel_policy(threads), events.begin(), middle, middle, events.end(), merged.begin(), key_less());
+			}));
+		}
+		cout << "  merge " << threads << (threads < 10 ? " " : "") << " threads : " << time * 1e3 << " ms, speedup "
+			<< sequential / time << "\n";
+	}
+	sink = sink + merged[n / 2].id;
+}
+
+int main(int argc, char** argv) {
+	// the size of a batch, 100M is the production size
+	size_t n = argc > 1 ? std::strtoull(argv[1], 0, 10) : 10000000;
+	// the size of an event log for the stable sort
+	size_t log_size = argc > 2 ? std::strtoull(argv[2], 0, 10) : 50000000;
+	cout << "----- Parallel sort scaling -----\n";
+	scaling_benchmark(n, 3);
+	cout << endl;
+
+	cout << "----- Radix sort against introsort -----\n";
+	for (size_t size = 1000; size <= n; size *= 10) {
+		radix_benchmark<uint32_t>("uint32_t ", size, 3, [](std::mt19937_64& rng) { return uint32_t(rng()); });
+		radix_benchmark<uint64_t>("uint64_t ", size, 3, [](std::mt19937_64& rng) { return uint64_t(rng()); });
+		radix_benchmark<double>("double   ", size, 3, [](std::mt19937_64& rng) {
+			return double(int64_t(rng())) * 1e-9;
+		});
+	}
+	record_benchmark(n, 3);
+	cout << endl;
+
+	cout << "----- Input patterns, " << n << " int -----\n";
+	std::mt19937 rng(3);
+	pattern_benchmark("random     ", n, 3, [&rng](size_t) { return int(rng()); });
+	pattern_benchmark("sorted     ", n, 3, [](size_t i) { return int(i); });
+	pattern_benchmark("reversed   ", n, 3, [n](size_t i) { return int(n - i); });
+	pattern_benchmark("16 distinct", n, 3, [&rng](size_t) { return int(rng() % 16); });
+	pattern_benchmark("organ pipe ", n, 3, [n](size_t i) { return int(i < n / 2 ? i : n - i); });
+	cout << endl;
+
+	cout << "----- Parallel stable sort and merge scaling -----\n";
+	stable_scaling_benchmark(log_size, 1);
+	cout << endl;
+
+	cout << "----- Stable sort against merge sort -----\n";
+	// the merge sort without a buffer is O(nlog^2n), 1M is enough to see it
+	for (size_t size = 10000; size <= n && size <= 1000000; size *= 10) {
+		stable_benchmark(size, 3);
+	}
+	cout << endl;
+
+	return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef _BENCH_UTIL_H_
+#define _BENCH_UTIL_H_
+
+#include <chrono>
+
+// the wall time of one call of f in seconds
+template <typename F>
+double seconds_of(F f) {
+	auto begin = std::chrono::steady_clock::now();
+	f();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+// the benchmarks add their answers here, which keeps them from being optimized away
+inline volatile double sink = 0;
+
+#endif
@@ -0,0 +1,247 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../stl_vector.hpp"
+#include "bench_util.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+// the move constructor may throw, so the vector copies it when it grows,
+// the same as the growth before move semantics
+template <typename T>
+struct copied_on_growth {
+	T value;
+
+	copied_on_growth(const T& v) : value(v) {}
+	copied_on_growth(const copied_on_growth&) = default;
+	copied_on_growth(copied_on_growth&& other) noexcept(false) : value(std::move(other.value)) {}
+	copied_on_growth& operator=(const copied_on_growth&) = default;
+	copied_on_growth& operator=(copied_on_growth&&) = default;
+};
+
+// owns a heap int like a unique_ptr, moving it has to null the source
+template <bool Relocatable>
+struct handle {
+	int* ptr;
+
+	handle(int v) : ptr(new int(v)) {}
+	handle(const handle& other) : ptr(new int(*other.ptr)) {}
+	handle(handle&& other) noexcept : ptr(other.ptr) { other.ptr = nullptr; }
+	handle& operator=(const handle& other) { *ptr = *other.ptr; return *this; }
+	handle& operator=(handle&& other) noexcept { std::swap(ptr, other.ptr); return *this; }
+	~handle() { delete ptr; }
+};
+
+namespace selfmadeSTL {
+	template <>
+	struct is_trivially_relocatable<handle<true>> {
+		typedef __true_type type;
+	};
+}
+
+// grow by push_back, insert and erase at the front of a short vector
+template <typename T>
+double relocation_time(size_t n, int repeats) {
+	return seconds_of([&]() {
+		for (int r = 0; r < repeats; ++r) {
+			vector<T> v;
+			for (size_t i = 0; i < n; ++i) {
+				v.push_back(T((int)i));
+			}
+			for (size_t i = 0; i < 1000; ++i) {
+				v.insert(v.begin() + i % 64, T((int)i));
+				v.erase(v.begin() + i % 32);
+			}
+			v.shrink_to_fit();
+		}
+	}) / repeats;
+}
+
+template <typename Relocated, typename Moved>
+void relocation_benchmark(const char* name, size_t n, int repeats) {
+	double relocated = relocation_time<Relocated>(n, repeats);
+	double moved = relocation_time<Moved>(n, repeats);
+	cout << name << ": memcpy " << relocated * 1e3 << " ms, move " << moved * 1e3
+		<< " ms, speedup " << moved / relocated << "x\n";
+}
+
+// counts the allocations of the vector space, and the bytes in use
+struct counting_allocator {
+	static size_t allocations;
+	static size_t bytes;
+	static size_t peak_bytes;
+
+	static void reset() { allocations = bytes = peak_bytes = 0; }
+	static void add(size_t n) {
+		bytes += n;
+		if (bytes > peak_bytes) {
+			peak_bytes = bytes;
+		}
+	}
+
+	void* allocate(size_t n) const {
+		++allocations;
+		add(n);
+		return alloc::allocate(n);
+	}
+	void deallocate(void* ptr, size_t n) const {
+		bytes -= n;
+		alloc::deallocate(ptr, n);
+	}
+	void* reallocate(void* ptr, size_t old_size, size_t new_size) const {
+		++allocations;
+		// both blocks are alive while the bytes are copied
+		add(new_size);
+		bytes -= old_size;
+		return alloc::reallocate(ptr, old_size, new_size);
+	}
+};
+size_t counting_allocator::allocations = 0;
+size_t counting_allocator::bytes = 0;
+size_t counting_allocator::peak_bytes = 0;
+
+// the growth before growth policies: double for one element, exact for a bulk insert
+struct old_growth {
+	static size_t next_capacity(size_t old_capacity, size_t required, size_t) {
+		if (required == old_capacity + 1) {
+			return old_capacity != 0 ? 2 * old_capacity : 1;
+		}
+		return required;
+	}
+};
+
+// append total ints, in chunks of 1 to max_chunk elements
+template <typename Growth>
+void append_benchmark(const char* name, size_t total, size_t max_chunk) {
+	typedef vector<int, counting_allocator, Growth> vector_type;
+	std::vector<int> chunk(max_chunk, 1);
+	unsigned int seed = 1;
+	counting_allocator::reset();
+	size_t size = 0;
+	double time = seconds_of([&]() {
+		vector_type v;
+		while (v.size() < total) {
+			seed = seed * 1103515245 + 12345;
+			size_t n = max_chunk == 1 ? 1 : (seed >> 16) % max_chunk + 1;
+			if (n == 1) {
+				v.push_back(1);
+			}
+			else {
+				v.insert(v.end(), chunk.data(), chunk.data() + n);
+			}
+		}
+		size = v.size();
+	});
+	cout << name << ": " << counting_allocator::allocations << " allocations, peak "
+		<< counting_allocator::peak_bytes / 1024 << " KiB for " << size * sizeof(int) / 1024
+		<< " KiB, " << time * 1e3 << " ms\n";
+}
+
+template <typename Growth>
+void growth_policy_benchmark(const char* name) {
+	cout << name << '\n';
+	append_benchmark<Growth>("  push_back 1M     ", 1000000, 1);
+	append_benchmark<Growth>("  bulk 1..100 1M   ", 1000000, 100);
+	append_benchmark<Growth>("  bulk 1..10000 2M ", 2000000, 10000);
+}
+
+// fill a vector<double> from a source, as a reader of a file or a socket does
+void ingestion_benchmark(size_t n, int repeats) {
+	std::vector<double> source(n, 1.5);
+	double resized = seconds_of([&]() {
+		for (int r = 0; r < repeats; ++r) {
+			vector<double> v;
+			v.resize(n);
+			memcpy(v.begin(), source.data(), n * sizeof(double));
+		}
+	}) / repeats;
+	double overwritten = seconds_of([&]() {
+		for (int r = 0; r < repeats; ++r) {
+			vector<double> v;
+			v.resize_for_overwrite(n);
+			memcpy(v.begin(), source.data(), n * sizeof(double));
+		}
+	}) / repeats;
+	double appended = seconds_of([&]() {
+		for (int r = 0; r < repeats; ++r) {
+			vector<double> v;
+			// in chunks of 64K, as they come
+			for (size_t done = 0; done < n; ) {
+				done += v.append(65536, [&](double* first, size_t count) {
+					size_t m = n - done < count ? n - done : count;
+					memcpy(first, source.data() + done, m * sizeof(double));
+					return m;
+				});
+			}
+		}
+	}) / repeats;
+	cout << "resize + memcpy              : " << resized * 1e3 << " ms\n";
+	cout << "resize_for_overwrite + memcpy: " << overwritten * 1e3 << " ms\n";
+	cout << "append in 64K chunks         : " << appended * 1e3 << " ms\n";
+}
+
+// push_back n copies of value into an empty vector, growth by doubling
+template <typename T>
+double growth_time(size_t n, const T& value, int repeats) {
+	return seconds_of([&]() {
+		for (int r = 0; r < repeats; ++r) {
+			vector<T> v;
+			for (size_t i = 0; i < n; ++i) {
+				v.push_back(value);
+			}
+		}
+	}) / repeats;
+}
+
+template <typename T>
+void growth_benchmark(const char* name, size_t n, const T& value, int repeats) {
+	// warm up the memory pool for both
+	growth_time(n, value, 1);
+	growth_time(n, copied_on_growth<T>(value), 1);
+	double moved = growth_time(n, value, repeats);
+	double copied = growth_time(n, copied_on_growth<T>(value), repeats);
+	cout << name << ": move " << moved * 1e3 << " ms, copy " << copied * 1e3
+		<< " ms, speedup " << copied / moved << "x\n";
+}
+
+int main() {
+	cout << "----- Growth by push_back -----\n";
+	growth_benchmark("vector<string> 100K     ", 100000, std::string(64, 'x'), 10);
+	growth_benchmark("vector<vector<int>> 100K", 100000, vector<int>(16, 1), 10);
+	cout << endl;
+
+	cout << "----- Relocation by memcpy -----\n";
+	relocation_benchmark<handle<true>, handle<false>>("handle 10K ", 10000, 20);
+	relocation_benchmark<handle<true>, handle<false>>("handle 100K", 100000, 5);
+	cout << endl;
+
+	cout << "----- Growth policy -----\n";
+	growth_policy_benchmark<old_growth>("double, exact bulk");
+	growth_policy_benchmark<growth_double>("growth_double");
+	growth_policy_benchmark<growth_half>("growth_half");
+	growth_policy_benchmark<page_growth<growth_half>>("page_growth<growth_half>");
+	cout << endl;
+
+	cout << "----- Ingestion of 16M doubles -----\n";
+	ingestion_benchmark(16 << 20, 5);
+	cout << endl;
+
+	cout << "----- Assignment of vector<string> 100K -----\n";
+	vector<std::string> source;
+	for (size_t i = 0; i < 100000; ++i) {
+		source.push_back(std::string(64, 'x'));
+	}
+	vector<std::string> target;
+	double copy_time = seconds_of([&]() { target = source; });
+	double move_time = seconds_of([&]() { target = std::move(source); });
+	cout << "copy assignment: " << copy_time * 1e3 << " ms\n";
+	cout << "move assignment: " << move_time * 1e3 << " ms\n";
+	cout << endl;
+
+	return 0;
+}
@@ -1,12 +1,20 @@
 #ifndef _ALGORITHM_H_
 #define _ALGORITHM_H_
 
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+#include "stl_construct.hpp"
+#include "stl_function.hpp"
 #include "stl_heap.hpp"
 #include "stl_iterator.hpp"
 #include "stl_pair.hpp"
+#include "stl_simd.hpp"
 #include "stl_type_traits.hpp"
 
 namespace selfmadeSTL {
@@ -38,10 +46,7 @@ namespace selfmadeSTL {
 	// find a iterator point to the maximal element for a range
 	//! O(n)
 	template <typename ForwardIterator>
-	ForwardIterator max_element(ForwardIterator first, ForwardIterator last) {
-		if (first == last) {
-			return last;
-		}
+	ForwardIterator __max_element(ForwardIterator first, ForwardIterator last, __false_type) {
 		ForwardIterator result = first;
 		for (++first; first != last; ++first) {
 			if (*result < *first) {
@@ -51,6 +56,21 @@ namespace selfmadeSTL {
 		return result;
 	}
 
+	//! O(n)
+	template <typename Pointer>
+	inline Pointer __max_element(Pointer first, Pointer last, __true_type) {
+		return first + __simd_max_element(first, last);
+	}
+
+	//! O(n)
+	template <typename ForwardIterator>
+	inline ForwardIterator max_element(ForwardIterator first, ForwardIterator last) {
+		if (first == last) {
+			return last;
+		}
+		return __max_element(first, last, typename __simd_pointer<ForwardIterator>::type());
+	}
+
 	//! O(n)
 	template <typename ForwardIterator, typename Compare>
 	ForwardIterator max_element(ForwardIterator first, ForwardIterator last, Compare comp) {
@@ -69,10 +89,7 @@ namespace selfmadeSTL {
 	// find a iterator point to the minimal element for a range
 	//! O(n)
 	template <typename ForwardIterator>
-	ForwardIterator min_element(ForwardIterator first, ForwardIterator last) {
-		if (first == last) {
-			return last;
-		}
+	ForwardIterator __min_element(ForwardIterator first, ForwardIterator last, __false_type) {
 		ForwardIterator result = first;
 		for (++first; first != last; ++first) {
 			if (*first < *result) {
@@ -82,6 +99,21 @@ namespace selfmadeSTL {
 		return result;
 	}
 
+	//! O(n)
+	template <typename Pointer>
+	inline Pointer __min_element(Pointer first, Pointer last, __true_type) {
+		return first + __simd_min_element(first, last);
+	}
+
+	//! O(n)
+	template <typename ForwardIterator>
+	inline ForwardIterator min_element(ForwardIterator first, ForwardIterator last) {
+		if (first == last) {
+			return last;
+		}
+		return __min_element(first, last, typename __simd_pointer<ForwardIterator>::type());
+	}
+
 	//! O(n)
 	template <typename ForwardIterator, typename Compare>
 	ForwardIterator min_element(ForwardIterator first, ForwardIterator last, Compare comp) {
@@ -97,6 +129,80 @@ namespace selfmadeSTL {
 		return result;
 	}
 
+	// find the first minimal and the last maximal element in one pass,
+	// the elements are compared in pairs, the smaller of a pair only with the
+	// minimum and the larger only with the maximum, 3 comparisons for 2 elements
+	//! O(n)
+	template <typename ForwardIterator, typename Compare>
+	pair<ForwardIterator, ForwardIterator> minmax_element(ForwardIterator first, ForwardIterator last, Compare comp) {
+		ForwardIterator smallest = first;
+		ForwardIterator largest = first;
+		if (first == last || ++first == last) {
+			return pair<ForwardIterator, ForwardIterator>(smallest, largest);
+		}
+		if (comp(*first, *smallest)) {
+			smallest = first;
+		}
+		else {
+			largest = first;
+		}
+		while (++first != last) {
+			ForwardIterator next = first;
+			if (++next == last) {
+				if (comp(*first, *smallest)) {
+					smallest = first;
+				}
+				else if (!comp(*first, *largest)) {
+					largest = first;
+				}
+				break;
+			}
+			if (comp(*next, *first)) {
+				if (comp(*next, *smallest)) {
+					smallest = next;
+				}
+				if (!comp(*first, *largest)) {
+					largest = first;
+				}
+			}
+			else {
+				if (comp(*first, *smallest)) {
+					smallest = first;
+				}
+				if (!comp(*next, *largest)) {
+					largest = next;
+				}
+			}
+			first = next;
+		}
+		return pair<ForwardIterator, ForwardIterator>(smallest, largest);
+	}
+
+	//! O(n)
+	template <typename ForwardIterator>
+	inline pair<ForwardIterator, ForwardIterator> __minmax_element(ForwardIterator first, ForwardIterator last, __false_type) {
+		typedef typename iterator_traits<ForwardIterator>::value_type T;
+		return selfmadeSTL::minmax_element(first, last, less<T>());
+	}
+
+	// integers only, a float NaN makes the pairwise order differ from the scan
+	//! O(n)
+	template <typename Pointer>
+	inline pair<Pointer, Pointer> __minmax_element(Pointer first, Pointer last, __true_type) {
+		if (first == last) {
+			return pair<Pointer, Pointer>(last, last);
+		}
+		size_t min_offset, max_offset;
+		__simd_minmax_element(first, last, min_offset, max_offset);
+		return pair<Pointer, Pointer>(first + min_offset, first + max_offset);
+	}
+
+	//! O(n)
+	template <typename ForwardIterator>
+	inline pair<ForwardIterator, ForwardIterator> minmax_element(ForwardIterator first, ForwardIterator last) {
+		return __minmax_element(first, last, typename __simd_integer_pointer<ForwardIterator>::type());
+	}
+
 	//! O(1)
 	template <typename T>
 	inline const T& median(const T& a, const T& b, const T& c) {
@@ -309,13 +415,66 @@ namespace selfmadeSTL {
 		return __copy_backward_dispatch<BidirectionalIterator1, BidirectionalIterator2>()(first, last, output);
 	}
 
+	//! move !//
+	// trivial assignment, the same as copy
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator>
+	inline OutputIterator __move(InputIterator first, InputIterator last, OutputIterator result, __true_type) {
+		return selfmadeSTL::copy(first, last, result);
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator>
+	inline OutputIterator __move(InputIterator first, InputIterator last, OutputIterator result, __false_type) {
+		for (; first != last; ++first, ++result) {
+			*result = std::move(*first);
+		}
+		return result;
+	}
+
+	// move the value in [`first`, `last`) to container
+	// start from `output`, the values left in [`first`, `last`) are moved from
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator>
+	inline OutputIterator move(InputIterator first, InputIterator last, OutputIterator output) {
+		typedef typename iterator_traits<InputIterator>::value_type T;
+		typedef typename __type_traits<T>::has_trivial_assignment_operator assign;
+		return __move(first, last, output, assign());
+	}
+
+	//! move_backward !//
+	//! O(n)
+	template <typename BidirectionalIterator1, typename BidirectionalIterator2>
+	inline BidirectionalIterator2 __move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last, BidirectionalIterator2 result, __true_type) {
+		return selfmadeSTL::copy_backward(first, last, result);
+	}
+
+	//! O(n)
+	template <typename BidirectionalIterator1, typename BidirectionalIterator2>
+	inline BidirectionalIterator2 __move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last, BidirectionalIterator2 result, __false_type) {
+		while (first != last) {
+			*--result = std::move(*--last);
+		}
+		return result;
+	}
+
+	// reversely move the value in [`first`, `last`) to container
+	// end with `output` (exclusive)
+	//! O(n)
+	template <typename BidirectionalIterator1, typename BidirectionalIterator2>
+	inline BidirectionalIterator2 move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last, BidirectionalIterator2 output) {
+		typedef typename iterator_traits<BidirectionalIterator1>::value_type T;
+		typedef typename __type_traits<T>::has_trivial_assignment_operator assign;
+		return __move_backward(first, last, output, assign());
+	}
+
 	//! comparison !//
 
 	// check if it is the same between [`first1`, `last1`) 
 	// and an iterator start from `first2`
 	//! O(n)
 	template <typename InputIterator1, typename InputIterator2>
-	bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+	inline bool __equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, __false_type) {
 		for (; first1 != last1; ++first1, ++first2) {
 			if (*first1 != *first2) {
 				return false;
@@ -323,6 +482,19 @@ namespace selfmadeSTL {
 		}
 		return true;
 	}
+
+	// contiguous arithmetic values, compared by a SIMD kernel
+	//! O(n)
+	template <typename Pointer1, typename Pointer2>
+	inline bool __equal(Pointer1 first1, Pointer1 last1, Pointer2 first2, __true_type) {
+		return __simd_mismatch(first1, last1, first2) == size_t(last1 - first1);
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2>
+	inline bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+		return __equal(first1, last1, first2, typename __simd_pointer_pair<InputIterator1, InputIterator2>::type());
+	}
 	
 	//! O(n)
 	template <typename InputIterator1, typename InputIterator2, typename BinaryOperator>
@@ -426,7 +598,7 @@ namespace selfmadeSTL {
 
 	//! O(n)
 	template <typename InputIterator1, typename InputIterator2>
-	pair<InputIterator1, InputIterator2> mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+	inline pair<InputIterator1, InputIterator2> __mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, __false_type) {
 		while (first1 != last1 && *first1 == *first2) {
 			++first1;
 			++first2;
@@ -434,6 +606,19 @@ namespace selfmadeSTL {
 		return pair<InputIterator1, InputIterator2>(first1, first2);
 	}
 
+	//! O(n)
+	template <typename Pointer1, typename Pointer2>
+	inline pair<Pointer1, Pointer2> __mismatch(Pointer1 first1, Pointer1 last1, Pointer2 first2, __true_type) {
+		size_t n = __simd_mismatch(first1, last1, first2);
+		return pair<Pointer1, Pointer2>(first1 + n, first2 + n);
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2>
+	inline pair<InputIterator1, InputIterator2> mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+		return __mismatch(first1, last1, first2, typename __simd_pointer_pair<InputIterator1, InputIterator2>::type());
+	}
+
 	//! O(n)
 	template <typename InputIterator1, typename InputIterator2, typename BinaryOperator>
 	pair<InputIterator1, InputIterator2> mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, BinaryOperator op) {
@@ -731,7 +916,7 @@ namespace selfmadeSTL {
 	// find the first two equal adjacent value
 	//! O(n)
 	template <typename ForwardIterator>
-	ForwardIterator adjacent_find(ForwardIterator first, ForwardIterator last) {
+	ForwardIterator __adjacent_find(ForwardIterator first, ForwardIterator last, __false_type) {
 		if (first == last) {
 			return last;
 		}
@@ -745,6 +930,18 @@ namespace selfmadeSTL {
 		return last;
 	}
 
+	//! O(n)
+	template <typename Pointer>
+	inline Pointer __adjacent_find(Pointer first, Pointer last, __true_type) {
+		return first + __simd_adjacent_find(first, last);
+	}
+
+	//! O(n)
+	template <typename ForwardIterator>
+	inline ForwardIterator adjacent_find(ForwardIterator first, ForwardIterator last) {
+		return __adjacent_find(first, last, typename __simd_pointer<ForwardIterator>::type());
+	}
+
 	//! O(n)
 	template <typename ForwardIterator, typename BinaryOperator>
 	ForwardIterator adjacent_find(ForwardIterator first, ForwardIterator last, BinaryOperator op) {
@@ -766,7 +963,7 @@ namespace selfmadeSTL {
 	// which are equal to `value`
 	//! O(n)
 	template <typename InputIterator, typename T>
-	typename iterator_traits<InputIterator>::difference_type count(InputIterator first, InputIterator last, const T& value) {
+	typename iterator_traits<InputIterator>::difference_type __count(InputIterator first, InputIterator last, const T& value, __false_type) {
 		typename iterator_traits<InputIterator>::difference_type n = 0;
 		for (; first != last; ++first) {
 			if (*first == value) {
@@ -776,11 +973,21 @@ namespace selfmadeSTL {
 		return n;
 	}
 
-	// count the number of elements in [`first`, `last`)
-	// which satisfy the Predicate.
+	//! O(n)
+	template <typename Pointer, typename T>
+	inline ptrdiff_t __count(Pointer first, Pointer last, const T& value, __true_type) {
+		return ptrdiff_t(__simd_count<simd_equal>(first, last, value));
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename T>
+	inline typename iterator_traits<InputIterator>::difference_type count(InputIterator first, InputIterator last, const T& value) {
+		return __count(first, last, value, typename __simd_search<InputIterator, T>::type());
+	}
+
 	//! O(n)
 	template <typename InputIterator, typename Predicate>
-	typename iterator_traits<InputIterator>::difference_type count_if(InputIterator first, InputIterator last, Predicate pred) {
+	typename iterator_traits<InputIterator>::difference_type __count_if(InputIterator first, InputIterator last, Predicate pred, __false_type) {
 		typename iterator_traits<InputIterator>::difference_type n = 0;
 		for (; first != last; ++first) {
 			if (pred(*first)) {
@@ -790,6 +997,22 @@ namespace selfmadeSTL {
 		return n;
 	}
 
+	// a binder of a comparison functor, each element is compared with the bound value
+	//! O(n)
+	template <typename Pointer, typename Predicate>
+	inline ptrdiff_t __count_if(Pointer first, Pointer last, Predicate pred, __true_type) {
+		typedef __simd_predicate<Predicate> simd;
+		return ptrdiff_t(__simd_count<simd::compare>(first, last, simd::value(pred)));
+	}
+
+	// count the number of elements in [`first`, `last`)
+	// which satisfy the Predicate.
+	//! O(n)
+	template <typename InputIterator, typename Predicate>
+	inline typename iterator_traits<InputIterator>::difference_type count_if(InputIterator first, InputIterator last, Predicate pred) {
+		return __count_if(first, last, pred, typename __simd_count_if<InputIterator, Predicate>::type());
+	}
+
 	//! search !//
 	// linear search
 	//! O(mn)
@@ -949,13 +1172,25 @@ namespace selfmadeSTL {
 	// find the first element that is equal to `value`
 	//! O(n)
 	template <typename InputIterator, typename T>
-	inline InputIterator find(InputIterator first, InputIterator last, const T& value) {
+	inline InputIterator __find(InputIterator first, InputIterator last, const T& value, __false_type) {
 		while (first != last && *first != value) {
 			++first;
 		}
 		return first;
 	}
 
+	//! O(n)
+	template <typename Pointer, typename T>
+	inline Pointer __find(Pointer first, Pointer last, const T& value, __true_type) {
+		return first + __simd_find(first, last, value);
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename T>
+	inline InputIterator find(InputIterator first, InputIterator last, const T& value) {
+		return __find(first, last, value, typename __simd_search<InputIterator, T>::type());
+	}
+
 	// find the first element that satisfy the Predicate
 	//! O(n)
 	template <typename InputIterator, typename Predicate>
@@ -1884,21 +2119,21 @@ namespace selfmadeSTL {
 	template <typename RandomAccessIterator, typename T, typename Compare>
 	void __partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, T*, Compare comp) {
 		// this heap will maintain the order in first to middle
-		make_heap(first, middle);
+		make_heap(first, middle, comp);
 		// for the rest elements
 		for (RandomAccessIterator i = middle; i < last; ++i) {
 			// if bigger than top, then it is too large
 			if (comp(*i, *first)) {
 				// we pop the top, push a new element in middle to last
-				__pop_heap(first, middle, i, difference_type(first), T(*i));
+				__pop_heap(first, middle, i, difference_type(first), T(*i), comp);
 			}
 		}
-		sort_heap(first, middle);
+		sort_heap(first, middle, comp);
 	}
 
 	template <typename RandomAccessIterator, typename Compare>
 	inline void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp) {
-		__partial_sort(first, middle, last, value_type(first));
+		__partial_sort(first, middle, last, value_type(first), comp);
 	}
 
 	// same as partial_sort, maybe different container
@@ -2048,88 +2283,282 @@ namespace selfmadeSTL {
 		}
 	}
 
-	//! O(n)
-	template <typename RandomAccessIterator, typename T>
-	RandomAccessIterator __unguarded_partition(RandomAccessIterator first, RandomAccessIterator last, T pivot) {
-		while (true) {
-			while (*first < pivot) {
-				++first;
-			}
-			--last;
-			while (pivot < *last) {
-				--last;
+	//! O(logn)
+	template <typename Size>
+	inline Size __log2(Size n) {
+		Size k;
+		for (k = 0; n != 1; n >>= 1) {
+			++k;
+		}
+		return k;
+	}
+
+	const int threshold = 16;
+	// above this size the pivot is the median of three medians of three
+	const ptrdiff_t ninther_threshold = 128;
+	// the comparisons of a block are kept as offsets, at most 255
+	const int partition_block_size = 64;
+
+	// sort three elements
+	template <typename RandomAccessIterator, typename Compare>
+	inline void __sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare comp) {
+		if (comp(*b, *a))
+			iter_swap(a, b);
+		if (comp(*c, *b))
+			iter_swap(b, c);
+		if (comp(*b, *a))
+			iter_swap(a, b);
+	}
+
+	// move the pivot to *first, the median of three, or the median of three medians
+	// of three for a large range, which defeats the patterns that fool a median of three
+	// an element no less than the pivot is left after it, at last - 1 for the median of
+	// three and at first + half + 1 for the ninther, whose last __sort3 leaves the
+	// largest median there while *(last - 1) may be smaller than the pivot
+	template <typename RandomAccessIterator, typename Compare>
+	void __choose_pivot(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		Distance half = (last - first) / 2;
+		if (last - first > ninther_threshold) {
+			__sort3(first, first + half, last - 1, comp);
+			__sort3(first + 1, first + (half - 1), last - 2, comp);
+			__sort3(first + 2, first + (half + 1), last - 3, comp);
+			__sort3(first + (half - 1), first + half, first + (half + 1), comp);
+			iter_swap(first, first + half);
+		}
+		else {
+			__sort3(first + half, first, last - 1, comp);
+		}
+	}
+
+	// swap the elements at the offsets of a left and a right block,
+	// the same number on both sides, a cycle of moves if they are not all paired
+	template <typename RandomAccessIterator>
+	inline void __swap_offsets(RandomAccessIterator left, RandomAccessIterator right,
+		unsigned char* offsets_l, unsigned char* offsets_r, size_t num, bool use_swaps) {
+		if (use_swaps) {
+			for (size_t i = 0; i < num; ++i) {
+				iter_swap(left + offsets_l[i], right - offsets_r[i]);
 			}
-			if (!(first < last)) {
-				return first;
+		}
+		else if (num > 0) {
+			RandomAccessIterator l = left + offsets_l[0];
+			RandomAccessIterator r = right - offsets_r[0];
+			auto temp = std::move(*l);
+			*l = std::move(*r);
+			for (size_t i = 1; i < num; ++i) {
+				l = left + offsets_l[i];
+				*r = std::move(*l);
+				r = right - offsets_r[i];
+				*l = std::move(*r);
 			}
-			iter_swap(first, last);
-			++first;
+			*r = std::move(temp);
 		}
 	}
 
+	// partition (first, last) by the pivot at *first, smaller elements go left and
+	// the others right, then the pivot goes between them and its position is returned
+	// the comparisons of a block are written as offsets of the elements on the wrong
+	// side without a branch, and then the elements are swapped in pairs (BlockQuicksort)
+	// second is true if no element was on the wrong side
 	//! O(n)
-	template <typename RandomAccessIterator, typename T, typename Compare>
-	RandomAccessIterator __unguarded_partition(RandomAccessIterator first, RandomAccessIterator last, T pivot, Compare comp) {
-		while (true) {
-			while (comp(*first, pivot)) {
-				++first;
+	template <typename RandomAccessIterator, typename Compare>
+	pair<RandomAccessIterator, bool> __partition_right(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		auto pivot = std::move(*first);
+		RandomAccessIterator begin = first;
+
+		// the first element no less than the pivot, __choose_pivot left one at last - 1
+		// or at first + half + 1, so the scan stops without a bound
+		while (comp(*++first, pivot));
+		// the first element less than the pivot from the right, guarded if nothing is before first
+		if (first - 1 == begin)
+			while (first < last && !comp(*--last, pivot));
+		else
+			while (!comp(*--last, pivot));
+
+		bool already_partitioned = !(first < last);
+		if (!already_partitioned) {
+			iter_swap(first, last);
+			++first;
+
+			unsigned char offsets_l[partition_block_size];
+			unsigned char offsets_r[partition_block_size];
+			RandomAccessIterator offsets_l_base = first;
+			RandomAccessIterator offsets_r_base = last;
+			size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+			while (first < last) {
+				// the unknown elements are given to the empty blocks
+				size_t num_unknown = last - first;
+				size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+				size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+				if (left_split > size_t(partition_block_size))
+					left_split = partition_block_size;
+				for (size_t i = 0; i < left_split; ++i) {
+					offsets_l[num_l] = (unsigned char)i;
+					num_l += !comp(*first, pivot);
+					++first;
+				}
+				if (right_split > size_t(partition_block_size))
+					right_split = partition_block_size;
+				for (size_t i = 0; i < right_split;) {
+					offsets_r[num_r] = (unsigned char)++i;
+					num_r += comp(*--last, pivot);
+				}
+
+				size_t num = min(num_l, num_r);
+				__swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+				num_l -= num;
+				num_r -= num;
+				start_l += num;
+				start_r += num;
+				if (num_l == 0) {
+					start_l = 0;
+					offsets_l_base = first;
+				}
+				if (num_r == 0) {
+					start_r = 0;
+					offsets_r_base = last;
+				}
 			}
-			--last;
-			while (comp(pivot, *last)) {
-				--last;
+
+			// one block is left, its elements go to the boundary
+			if (num_l) {
+				while (num_l--)
+					iter_swap(offsets_l_base + Distance(offsets_l[start_l + num_l]), --last);
+				first = last;
 			}
-			if (!(first < last)) {
-				return first;
+			if (num_r) {
+				while (num_r--) {
+					iter_swap(offsets_r_base - Distance(offsets_r[start_r + num_r]), first);
+					++first;
+				}
+				last = first;
 			}
-			iter_swap(first, last);
-			++first;
 		}
+
+		RandomAccessIterator pivot_pos = first - 1;
+		*begin = std::move(*pivot_pos);
+		*pivot_pos = std::move(pivot);
+		return pair<RandomAccessIterator, bool>(pivot_pos, already_partitioned);
 	}
 
-	// find the nth element of a range
-	// similar to partition, we need not to sort it
+	// partition [first, last) by the pivot at *first, elements equal to the pivot go left
+	// for a pivot equal to the element before the range, which is no greater than
+	// any element in the range, so the left part is all equal to the pivot and done
 	//! O(n)
-	template <typename RandomAccessIterator, typename T>
-	void __nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, T*) {
-		while (last - first > 3) {
-			RandomAccessIterator pivot = __unguarded_partition(first, last, T(median(*first, *(first + ((last - first) / 2)), *(last - 1))));
-			if (pivot <= nth) {
-				first = pivot;
-			}
-			else {
-				last = pivot;
-			}
+	template <typename RandomAccessIterator, typename Compare>
+	RandomAccessIterator __partition_left(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		auto pivot = std::move(*first);
+		RandomAccessIterator begin = first;
+		RandomAccessIterator end = last;
+
+		while (comp(pivot, *--last));
+		if (last + 1 == end)
+			while (first < last && !comp(pivot, *++first));
+		else
+			while (!comp(pivot, *++first));
+
+		while (first < last) {
+			iter_swap(first, last);
+			while (comp(pivot, *--last));
+			while (!comp(pivot, *++first));
 		}
-		__insertion_sort(first, last);
+
+		RandomAccessIterator pivot_pos = last;
+		*begin = std::move(*pivot_pos);
+		*pivot_pos = std::move(pivot);
+		return pivot_pos;
 	}
 
+	// after a bad partition, some elements of both parts are swapped
+	// to break the pattern that made it
 	template <typename RandomAccessIterator>
-	inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last) {
-		__nth_element(first, nth, last, value_type(first));
+	void __break_patterns(RandomAccessIterator first, RandomAccessIterator pivot, RandomAccessIterator last) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		Distance l_size = pivot - first;
+		Distance r_size = last - (pivot + 1);
+		if (l_size >= threshold) {
+			iter_swap(first, first + l_size / 4);
+			iter_swap(pivot - 1, pivot - l_size / 4);
+			if (l_size > ninther_threshold) {
+				iter_swap(first + 1, first + (l_size / 4 + 1));
+				iter_swap(first + 2, first + (l_size / 4 + 2));
+				iter_swap(pivot - 2, pivot - (l_size / 4 + 1));
+				iter_swap(pivot - 3, pivot - (l_size / 4 + 2));
+			}
+		}
+		if (r_size >= threshold) {
+			iter_swap(pivot + 1, pivot + (1 + r_size / 4));
+			iter_swap(last - 1, last - r_size / 4);
+			if (r_size > ninther_threshold) {
+				iter_swap(pivot + 2, pivot + (2 + r_size / 4));
+				iter_swap(pivot + 3, pivot + (3 + r_size / 4));
+				iter_swap(last - 2, last - (1 + r_size / 4));
+				iter_swap(last - 3, last - (2 + r_size / 4));
+			}
+		}
 	}
 
+	// find the nth element of a range
+	// similar to partition, we need not to sort it
+	// only the part with nth is partitioned again, the pivots and the bad partitions
+	// are handled as in __introsort_loop, and after depth_limit bad partitions
+	// the rest is done by heap selection
 	//! O(n)
-	template <typename RandomAccessIterator, typename T, typename Compare>
-	void __nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, T*, Compare comp) {
-		while (last - first > 3) {
-			RandomAccessIterator pivot = __unguarded_partition(first, last, T(median(*first, *(first + ((last - first) / 2)), *(last - 1), comp)), comp);
-			if (pivot <= nth) {
-				first = pivot;
+	template <typename RandomAccessIterator, typename Compare>
+	void __nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		if (nth == last)
+			return;
+		bool leftmost = true;
+		Distance depth_limit = __log2(last - first);
+		while (last - first > threshold) {
+			Distance len = last - first;
+			__choose_pivot(first, last, comp);
+			// many equal elements, they are put together and skipped
+			if (!leftmost && !comp(*(first - 1), *first)) {
+				RandomAccessIterator pivot = __partition_left(first, last, comp);
+				if (!(pivot < nth))
+					return;
+				first = pivot + 1;
+				continue;
 			}
-			else {
+			RandomAccessIterator pivot = __partition_right(first, last, comp).first;
+			if (pivot == nth)
+				return;
+			if (pivot - first < len / 8 || last - (pivot + 1) < len / 8) {
+				if (depth_limit == 0) {
+					partial_sort(first, nth + 1, last, comp);
+					return;
+				}
+				--depth_limit;
+				__break_patterns(first, pivot, last);
+			}
+			if (nth < pivot) {
 				last = pivot;
 			}
+			else {
+				first = pivot + 1;
+				leftmost = false;
+			}
 		}
 		__insertion_sort(first, last, comp);
 	}
 
+	template <typename RandomAccessIterator>
+	inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		__nth_element(first, nth, last, less<T>());
+	}
+
 	template <typename RandomAccessIterator, typename Compare>
 	inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, Compare comp) {
-		__nth_element(first, nth, last, value_type(first), comp);
+		__nth_element(first, nth, last, comp);
 	}
 
-	const int threshold = 16;
-
 	//! O(threshold^2)
 	template <typename RandomAccessIterator>
 	void __final_insertion_sort(RandomAccessIterator first, RandomAccessIterator last) {
@@ -2161,58 +2590,415 @@ namespace selfmadeSTL {
 		}
 	}
 
-	//! O(nlogn)
-	template <typename RandomAccessIterator, typename T, typename Size>
-	void __introsort_loop(RandomAccessIterator first, RandomAccessIterator last, T*, Size depth_limit) {
-		while (last - first > threshold) {
-			if (depth_limit == 0) {
-				// turns into heap sort if introsort works bad
-				// (to much partition)
-				partial_sort(first, last, last);
-				return;
+	// insertion sort of a range after a partition, there is an element no greater
+	// than all of them before first unless leftmost
+	template <typename RandomAccessIterator, typename Compare>
+	inline void __leaf_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, bool leftmost) {
+		if (leftmost) {
+			__insertion_sort(first, last, comp);
+		}
+		else {
+			for (RandomAccessIterator i = first; i != last; ++i) {
+				__unguarded_linear_insert(i, *i, comp);
+			}
+		}
+	}
+
+	// insertion sort that gives up after a few moves, true if the range is sorted
+	// a partition that swapped nothing is likely in a sorted range
+	//! O(n)
+	template <typename RandomAccessIterator, typename Compare>
+	bool __partial_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		const size_t limit = 8;
+		if (first == last)
+			return true;
+		size_t moves = 0;
+		for (RandomAccessIterator i = first + 1; i != last; ++i) {
+			if (moves > limit)
+				return false;
+			RandomAccessIterator sift = i;
+			RandomAccessIterator sift_1 = i - 1;
+			if (comp(*sift, *sift_1)) {
+				auto value = std::move(*sift);
+				do {
+					*sift-- = std::move(*sift_1);
+				} while (sift != first && comp(value, *--sift_1));
+				*sift = std::move(value);
+				moves += i - sift;
 			}
-			--depth_limit;
-			RandomAccessIterator pivot = __unguarded_partition(first, last, T(median(*first, *(first + ((last - first) / 2)), *(last - 1))));
-			__introsort_loop(pivot, last, value_type(first), depth_limit);
-			last = pivot;
 		}
+		return true;
 	}
 
+	// pattern-defeating introsort, the range is sorted at the end
+	// the pivot is chosen by __choose_pivot and the range partitioned by blocks,
+	// a range with many elements equal to the one before it puts them together,
+	// a partition that swapped nothing tries a partial insertion sort for a sorted range
+	// depth_limit counts the bad partitions (a part less than 1/8), some elements
+	// are shuffled after one, and it turns into heap sort when there are too many
+	// small ranges are sorted by insertion sort, leftmost is false if there is an
+	// element no greater than the range before it
 	//! O(nlogn)
 	template <typename RandomAccessIterator, typename T, typename Size, typename Compare>
-	void __introsort_loop(RandomAccessIterator first, RandomAccessIterator last, T*, Size depth_limit, Compare comp) {
-		while (last - first > threshold) {
-			if (depth_limit == 0) {
-				partial_sort(first, last, last, comp);
+	void __introsort_loop(RandomAccessIterator first, RandomAccessIterator last, T*, Size depth_limit, Compare comp, bool leftmost = true) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		while (true) {
+			Distance len = last - first;
+			if (len <= threshold) {
+				__leaf_insertion_sort(first, last, comp, leftmost);
+				return;
+			}
+			__choose_pivot(first, last, comp);
+			if (!leftmost && !comp(*(first - 1), *first)) {
+				first = __partition_left(first, last, comp) + 1;
+				continue;
+			}
+
+			pair<RandomAccessIterator, bool> cut = __partition_right(first, last, comp);
+			RandomAccessIterator pivot = cut.first;
+			Distance l_size = pivot - first;
+			Distance r_size = last - (pivot + 1);
+			if (l_size < len / 8 || r_size < len / 8) {
+				if (depth_limit == 0) {
+					// turns into heap sort if introsort works bad
+					// (to much partition)
+					partial_sort(first, last, last, comp);
+					return;
+				}
+				--depth_limit;
+				__break_patterns(first, pivot, last);
+			}
+			else if (cut.second && __partial_insertion_sort(first, pivot, comp)
+				&& __partial_insertion_sort(pivot + 1, last, comp)) {
 				return;
 			}
-			--depth_limit;
-			RandomAccessIterator pivot = __unguarded_partition(first, last, T(median(*first, *(first + ((last - first) / 2)), *(last - 1), comp)), comp);
-			__introsort_loop(pivot, last, value_type(first), depth_limit, comp);
-			last = pivot;
+
+			__introsort_loop(first, pivot, (T*)0, depth_limit, comp, leftmost);
+			first = pivot + 1;
+			leftmost = false;
 		}
 	}
 
-	//! O(logn)
-	template <typename Size>
-	inline Size __log2(Size n) {
-		Size k;
-		for (k = 0; n != 1; n >>= 1) {
-			++k;
+	//! O(nlogn)
+	template <typename RandomAccessIterator, typename T, typename Size>
+	inline void __introsort_loop(RandomAccessIterator first, RandomAccessIterator last, T*, Size depth_limit) {
+		__introsort_loop(first, last, (T*)0, depth_limit, less<T>());
+	}
+
+
+	//! radix sort !//
+
+	// the unsigned key of a size
+	template <size_t Size>
+	struct __radix_unsigned {};
+	template <>
+	struct __radix_unsigned<1> { typedef uint8_t type; };
+	template <>
+	struct __radix_unsigned<2> { typedef uint16_t type; };
+	template <>
+	struct __radix_unsigned<4> { typedef uint32_t type; };
+	template <>
+	struct __radix_unsigned<8> { typedef uint64_t type; };
+
+	// maps an arithmetic value to an unsigned key of the same size,
+	// whose order as an unsigned integer is the order of the value
+	// integers up to 64 bits, float and double can be radix sorted
+	template <typename T,
+		bool Integral = std::is_integral<T>::value && sizeof(T) <= 8,
+		bool Floating = std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)>
+	struct __radix_key {
+		typedef __false_type sortable;
+	};
+
+	template <typename T>
+	struct __radix_key<T, true, false> {
+		typedef __true_type sortable;
+		typedef typename __radix_unsigned<sizeof(T)>::type key_type;
+
+		// a signed value has its sign bit flipped, the negative ones come first
+		static key_type key(T value) {
+			const key_type sign = std::is_signed<T>::value ? key_type(key_type(1) << (sizeof(T) * 8 - 1)) : key_type(0);
+			return key_type(static_cast<key_type>(value) ^ sign);
+		}
+	};
+
+	template <typename T>
+	struct __radix_key<T, false, true> {
+		typedef __true_type sortable;
+		typedef typename __radix_unsigned<sizeof(T)>::type key_type;
+
+		// IEEE order: a positive value has its sign bit set, a negative one has
+		// all its bits flipped, so a larger magnitude comes first
+		// -0.0 comes before 0.0, and NaNs are at both ends by their sign
+		static key_type key(T value) {
+			key_type bits;
+			memcpy(&bits, &value, sizeof(T));
+			const key_type sign = key_type(key_type(1) << (sizeof(T) * 8 - 1));
+			const key_type mask = key_type(key_type(0) - (bits >> (sizeof(T) * 8 - 1)));
+			return key_type(bits ^ (mask | sign));
+		}
+	};
+
+	// the key of a value in ascending or descending order
+	template <typename T, bool Descending>
+	struct __radix_value_key {
+		typedef typename __radix_key<T>::key_type key_type;
+
+		key_type operator()(T value) const {
+			return Descending ? key_type(~__radix_key<T>::key(value)) : __radix_key<T>::key(value);
+		}
+	};
+
+	// the key of a record and where it was
+	template <typename Key>
+	struct __radix_item {
+		Key key;
+		size_t index;
+	};
+
+	template <typename Key>
+	struct __radix_item_key {
+		Key operator()(const __radix_item<Key>& item) const { return item.key; }
+	};
+
+	const int radix_bits = 8;
+	const size_t radix_size = size_t(1) << radix_bits;
+	// below this size of 4 byte keys sort() does not turn into radix sort
+	const ptrdiff_t radix_sort_threshold = 1024;
+
+	// one pass of LSD radix sort, the values go from [first, last) to result
+	// in the order of their digit at shift, offset is where each digit starts
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator, typename KeyOf>
+	void __radix_scatter(InputIterator first, InputIterator last, OutputIterator result, KeyOf key_of, int shift, size_t* offset) {
+		for (; first != last; ++first) {
+			size_t digit = size_t(key_of(*first) >> shift) & (radix_size - 1);
+			*(result + offset[digit]++) = std::move(*first);
+		}
+	}
+
+	// LSD radix sort, stable, buffer has the space of last - first values
+	// all the histograms are counted in one pass, a digit that all the keys
+	// share is skipped, and the values move between the range and buffer
+	//! O(n * sizeof(key))
+	template <typename RandomAccessIterator, typename T, typename KeyOf>
+	void __lsd_radix_sort(RandomAccessIterator first, RandomAccessIterator last, T* buffer, KeyOf key_of) {
+		typedef decltype(key_of(*first)) key_type;
+		const int digits = sizeof(key_type) * 8 / radix_bits;
+		const size_t n = last - first;
+		size_t count[sizeof(key_type) * 8 / radix_bits][radix_size] = {};
+		for (RandomAccessIterator i = first; i != last; ++i) {
+			key_type key = key_of(*i);
+			for (int d = 0; d < digits; ++d) {
+				++count[d][size_t(key >> (d * radix_bits)) & (radix_size - 1)];
+			}
+		}
+
+		bool in_buffer = false;
+		for (int d = 0; d < digits; ++d) {
+			const int shift = d * radix_bits;
+			if (count[d][size_t(key_of(*first) >> shift) & (radix_size - 1)] == n)
+				continue;
+			// count to the start of each digit
+			size_t sum = 0;
+			for (size_t b = 0; b < radix_size; ++b) {
+				size_t c = count[d][b];
+				count[d][b] = sum;
+				sum += c;
+			}
+			if (in_buffer)
+				__radix_scatter(buffer, buffer + n, first, key_of, shift, count[d]);
+			else
+				__radix_scatter(first, last, buffer, key_of, shift, count[d]);
+			in_buffer = !in_buffer;
+		}
+		if (in_buffer)
+			selfmadeSTL::move(buffer, buffer + n, first);
+	}
+
+	// in place MSD radix sort (American flag sort), not stable
+	// the values of a digit are swapped into its bucket one by one,
+	// then each bucket is sorted by the next digit, a small one by insertion sort
+	//! O(n * sizeof(key))
+	template <typename RandomAccessIterator, typename KeyOf>
+	void __msd_radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key_of, int shift) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		if (last - first <= threshold) {
+			__insertion_sort(first, last, [key_of](const T& a, const T& b) {
+				return key_of(a) < key_of(b);
+			});
+			return;
+		}
+		size_t head[radix_size] = {};
+		size_t tail[radix_size];
+		for (RandomAccessIterator i = first; i != last; ++i) {
+			++head[size_t(key_of(*i) >> shift) & (radix_size - 1)];
+		}
+		size_t sum = 0;
+		for (size_t b = 0; b < radix_size; ++b) {
+			size_t c = head[b];
+			head[b] = sum;
+			sum += c;
+			tail[b] = sum;
+		}
+		for (size_t b = 0; b < radix_size; ++b) {
+			while (head[b] < tail[b]) {
+				auto value = std::move(*(first + head[b]));
+				size_t digit = size_t(key_of(value) >> shift) & (radix_size - 1);
+				while (digit != b) {
+					std::swap(value, *(first + head[digit]++));
+					digit = size_t(key_of(value) >> shift) & (radix_size - 1);
+				}
+				*(first + head[b]++) = std::move(value);
+			}
+		}
+		if (shift == 0)
+			return;
+		size_t start = 0;
+		for (size_t b = 0; b < radix_size; ++b) {
+			__msd_radix_sort(first + start, first + tail[b], key_of, shift - radix_bits);
+			start = tail[b];
 		}
-		return k;
+	}
+
+	// LSD with a buffer, in place MSD if there is no space for the buffer
+	template <typename RandomAccessIterator, typename T, typename KeyOf>
+	void __radix_sort(RandomAccessIterator first, RandomAccessIterator last, T*, KeyOf key_of) {
+		typedef decltype(key_of(*first)) key_type;
+		if (last - first < 2)
+			return;
+		std::unique_ptr<T[]> buffer(new (std::nothrow) T[last - first]);
+		if (buffer)
+			__lsd_radix_sort(first, last, buffer.get(), key_of);
+		else
+			__msd_radix_sort(first, last, key_of, int(sizeof(key_type) * 8) - radix_bits);
+	}
+
+	// sort integers, float or double in ascending order without comparisons
+	//! O(n * sizeof(T))
+	template <typename RandomAccessIterator>
+	inline void radix_sort(RandomAccessIterator first, RandomAccessIterator last) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		static_assert(std::is_same<typename __radix_key<T>::sortable, __true_type>::value, "radix_sort needs integers, float or double");
+		__radix_sort(first, last, (T*)0, __radix_value_key<T, false>());
+	}
+
+	// move the records so that the record at i is the one that was at index[i]
+	// each cycle of the permutation is moved round with one temporary
+	//! O(n)
+	template <typename RandomAccessIterator, typename Key>
+	void __radix_permute(RandomAccessIterator first, __radix_item<Key>* items, size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			if (items[i].index == i)
+				continue;
+			auto temp = std::move(*(first + i));
+			size_t j = i;
+			while (items[j].index != i) {
+				size_t from = items[j].index;
+				*(first + j) = std::move(*(first + from));
+				items[j].index = j;
+				j = from;
+			}
+			*(first + j) = std::move(temp);
+			items[j].index = j;
+		}
+	}
+
+	// the same as above, the records are gathered in order into buffer and moved back,
+	// which reads at random but writes in order
+	//! O(n)
+	template <typename RandomAccessIterator, typename Key, typename T>
+	void __radix_gather(RandomAccessIterator first, __radix_item<Key>* items, size_t n, T* buffer) {
+		size_t built = 0;
+		try {
+			for (; built < n; ++built) {
+				construct(buffer + built, std::move(*(first + ptrdiff_t(items[built].index))));
+			}
+		}
+		catch (const std::exception&) {
+			destory(buffer, buffer + built);
+			throw;
+		}
+		selfmadeSTL::move(buffer, buffer + n, first);
+		destory(buffer, buffer + n);
+	}
+
+	// sort records by an integer, float or double key in ascending order, stable
+	// key(record) gives the key, it is called once per record, the keys are
+	// sorted with where they were and then the records are moved once
+	//! O(n * sizeof(key))
+	template <typename RandomAccessIterator, typename KeyExtractor>
+	void radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyExtractor key) {
+		typedef typename std::decay<decltype(key(*first))>::type K;
+		static_assert(std::is_same<typename __radix_key<K>::sortable, __true_type>::value, "radix_sort needs integer, float or double keys");
+		typedef typename __radix_key<K>::key_type key_type;
+		const size_t n = last - first;
+		if (n < 2)
+			return;
+		std::unique_ptr<__radix_item<key_type>[]> items(new __radix_item<key_type>[2 * n]);
+		for (size_t i = 0; i < n; ++i) {
+			items[i].key = __radix_key<K>::key(key(*(first + ptrdiff_t(i))));
+			items[i].index = i;
+		}
+		__lsd_radix_sort(items.get(), items.get() + n, items.get() + n, __radix_item_key<key_type>());
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		T* buffer = static_cast<T*>(::operator new(n * sizeof(T), std::nothrow));
+		if (buffer) {
+			try {
+				__radix_gather(first, items.get(), n, buffer);
+			}
+			catch (const std::exception&) {
+				::operator delete(buffer);
+				throw;
+			}
+			::operator delete(buffer);
+		}
+		else {
+			__radix_permute(first, items.get(), n);
+		}
+	}
+
+	// sort() turns into radix sort for less and greater of an arithmetic value
+	template <typename Compare, typename T>
+	struct __radix_order {
+		typedef __false_type sortable;
+	};
+
+	template <typename T>
+	struct __radix_order<less<T>, T> {
+		typedef typename __radix_key<T>::sortable sortable;
+		static const bool descending = false;
+	};
+
+	template <typename T>
+	struct __radix_order<greater<T>, T> {
+		typedef typename __radix_key<T>::sortable sortable;
+		static const bool descending = true;
+	};
+
+	template <typename RandomAccessIterator, typename T, typename Compare>
+	inline bool __radix_sorted(RandomAccessIterator, RandomAccessIterator, T*, Compare, __false_type) {
+		return false;
+	}
+
+	// the range is sorted if it is large enough for radix sort
+	template <typename RandomAccessIterator, typename T, typename Compare>
+	inline bool __radix_sorted(RandomAccessIterator first, RandomAccessIterator last, T*, Compare, __true_type) {
+		// a wider key takes more passes
+		if (last - first < radix_sort_threshold * ptrdiff_t(sizeof(T)) / 4)
+			return false;
+		__radix_sort(first, last, (T*)0, __radix_value_key<T, __radix_order<Compare, T>::descending>());
+		return true;
 	}
 
 	//! O(nlogn)
 	template <typename RandomAccessIterator>
 	inline void sort(RandomAccessIterator first, RandomAccessIterator last) {
 		if (first != last) {
-			// introsort will break a range into several ranges,
-			// each range is no longer than threshold.
-			// elements in previous range will not bigger than elements in posterior range
-			// so insertion sort can handle each range without affecting other ranges
-			__introsort_loop(first, last, value_type(first), __log2(last - first) * 2);
-			__final_insertion_sort(first, last);
+			typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+			if (__radix_sorted(first, last, (T*)0, less<T>(), typename __radix_order<less<T>, T>::sortable()))
+				return;
+			__introsort_loop(first, last, (T*)0, __log2(last - first), less<T>());
 		}
 	}
 
@@ -2220,64 +3006,79 @@ namespace selfmadeSTL {
 	template <typename RandomAccessIterator, typename Compare>
 	inline void sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
 		if (first != last) {
-			__introsort_loop(first, last, value_type(first), __log2(last - first) * 2, comp);
-			__final_insertion_sort(first, last, comp);
+			typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+			if (__radix_sorted(first, last, (T*)0, comp, typename __radix_order<Compare, T>::sortable()))
+				return;
+			__introsort_loop(first, last, (T*)0, __log2(last - first), comp);
 		}
 	}
 
-	// prepare for merge sort
-	//! O(n)
-	template <typename BidirectionalIterator, typename Distance>
-	void __merge_without_buffer(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last, Distance len1, Distance len2) {
-		if (len1 == 0 || len2 == 0) {
-			return;
-		}
-		if (len1 + len2 == 2) {
-			if (*middle < *first) {
-				iter_swap(first, middle);
+	//! temporary buffer !//
+
+	// raw memory for at most requested values of T, a smaller size is asked
+	// each time the allocation fails, size() is 0 if nothing could be got
+	// a value that is not trivial is made from *seed and moved along the
+	// buffer, then moved back to *seed, so every slot holds a valid value
+	// without a default constructor
+	template <typename ForwardIterator, typename T>
+	class __temporary_buffer {
+	private:
+		ptrdiff_t len;
+		T* buffer;
+
+		void construct_aux(ForwardIterator, __true_type) {}
+
+		void construct_aux(ForwardIterator seed, __false_type) {
+			T* curr = buffer;
+			try {
+				construct(curr, std::move(*seed));
+				for (++curr; curr != buffer + len; ++curr) {
+					construct(curr, std::move(*(curr - 1)));
+				}
+				*seed = std::move(*(curr - 1));
+			}
+			catch (const std::exception&) {
+				destory(buffer, curr);
+				::operator delete(buffer);
+				buffer = 0;
+				len = 0;
 			}
-			return;
-		}
-		BidirectionalIterator first_cut = first;
-		BidirectionalIterator second_cut = middle;
-		Distance len11 = 0;
-		Distance len22 = 0;
-		if (len1 > len2) {
-			len11 = len1 / 2;
-			advance(first_cut, len11);
-			second_cut = lower_bound(middle, last, *first_cut);
-			len22 = distance(middle, second_cut);
-		}
-		else {
-			len22 = len2 / 2;
-			advance(second_cut, len22);
-			first_cut = upper_bound(first, middle, *second_cut);
-			len11 = distance(first, first_cut);
 		}
-		// rotate smaller to the front of the range
-		rotate(first_cut, middle, second_cut);
-		BidirectionalIterator new_middle = first_cut + len22;
-		__merge_without_buffer(first, first_cut, new_middle, len11, len22);
-		__merge_without_buffer(new_middle, second_cut, last, len1 - len11, len2 - len22);
-	}
 
-	template <typename BidirectionalIterator, typename T, typename Distance>
-	inline void __inplace_merge(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last, T*, Distance*) {
-		Distance len1 = distance(first, middle);
-		Distance len2 = distance(middle, last);
+	public:
+		__temporary_buffer(ForwardIterator seed, ptrdiff_t requested) : len(0), buffer(0) {
+			if (requested <= 0)
+				return;
+			len = min(requested, ptrdiff_t(PTRDIFF_MAX / sizeof(T)));
+			while (len > 0) {
+				buffer = static_cast<T*>(::operator new(len * sizeof(T), std::nothrow));
+				if (buffer != 0)
+					break;
+				len /= 2;
+			}
+			if (buffer != 0) {
+				typedef typename __type_traits<T>::is_POD_type is_POD;
+				construct_aux(seed, is_POD());
+			}
+		}
 
-		__merge_without_buffer(first, middle, last, len1, len2);
-	}
+		__temporary_buffer(const __temporary_buffer&) = delete;
+		__temporary_buffer& operator=(const __temporary_buffer&) = delete;
 
-	template <typename BidirectionalIterator>
-	inline void inplace_merge(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last) {
-		if (first == middle || middle == last) {
-			return;
+		~__temporary_buffer() {
+			destory(buffer, buffer + len);
+			::operator delete(buffer);
 		}
-		__inplace_merge(first, middle, last, value_type(first), difference_type(first));
-	}
 
-	//! O(n)
+		T* begin() const { return buffer; }
+		T* end() const { return buffer + len; }
+		ptrdiff_t size() const { return len; }
+	};
+
+	//! inplace merge !//
+
+	// rotation merge, for the case no buffer can be got
+	//! O(nlogn)
 	template <typename BidirectionalIterator, typename Distance, typename Compare>
 	void __merge_without_buffer(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last, Distance len1, Distance len2, Compare comp) {
 		if (len1 == 0 || len2 == 0) {
@@ -2307,19 +3108,157 @@ namespace selfmadeSTL {
 		}
 		// rotate smaller to the front of the range
 		rotate(first_cut, middle, second_cut);
-		BidirectionalIterator new_middle = first_cut + len22;
+		BidirectionalIterator new_middle = first_cut;
+		advance(new_middle, len22);
 		__merge_without_buffer(first, first_cut, new_middle, len11, len22, comp);
 		__merge_without_buffer(new_middle, second_cut, last, len1 - len11, len2 - len22, comp);
 	}
 
+	// merge [first1, last1) in the buffer with [first2, last2) into result,
+	// which ends where [first2, last2) ends, so the rest of it is in place
+	//! O(n)
+	template <typename InputIterator, typename BidirectionalIterator, typename Compare>
+	void __move_merge_forward(InputIterator first1, InputIterator last1, BidirectionalIterator first2,
+		BidirectionalIterator last2, BidirectionalIterator result, Compare comp) {
+		while (first1 != last1 && first2 != last2) {
+			if (comp(*first2, *first1)) {
+				*result = std::move(*first2);
+				++first2;
+			}
+			else {
+				*result = std::move(*first1);
+				++first1;
+			}
+			++result;
+		}
+		selfmadeSTL::move(first1, last1, result);
+	}
+
+	// merge [first1, last1) with [first2, last2) in the buffer from the back,
+	// result is the end of the merged range, which begins with [first1, last1)
+	//! O(n)
+	template <typename BidirectionalIterator, typename Pointer, typename Compare>
+	void __move_merge_backward(BidirectionalIterator first1, BidirectionalIterator last1, Pointer first2,
+		Pointer last2, BidirectionalIterator result, Compare comp) {
+		if (first1 == last1) {
+			selfmadeSTL::move_backward(first2, last2, result);
+			return;
+		}
+		if (first2 == last2) {
+			return;
+		}
+		--last1;
+		--last2;
+		while (true) {
+			// equal values are taken from the buffer first, so the merge is stable
+			if (comp(*last2, *last1)) {
+				*--result = std::move(*last1);
+				if (first1 == last1) {
+					selfmadeSTL::move_backward(first2, ++last2, result);
+					return;
+				}
+				--last1;
+			}
+			else {
+				*--result = std::move(*last2);
+				if (first2 == last2) {
+					return;
+				}
+				--last2;
+			}
+		}
+	}
+
+	// rotate through the buffer when the smaller part fits in it,
+	// return the new position of middle
+	//! O(n)
+	template <typename BidirectionalIterator, typename Pointer, typename Distance>
+	BidirectionalIterator __rotate_adaptive(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last,
+		Distance len1, Distance len2, Pointer buffer, Distance buffer_size) {
+		if (len1 > len2 && len2 <= buffer_size) {
+			if (len2 == 0)
+				return first;
+			Pointer buffer_end = selfmadeSTL::move(middle, last, buffer);
+			selfmadeSTL::move_backward(first, middle, last);
+			return selfmadeSTL::move(buffer, buffer_end, first);
+		}
+		else if (len1 <= buffer_size) {
+			if (len1 == 0)
+				return last;
+			Pointer buffer_end = selfmadeSTL::move(first, middle, buffer);
+			selfmadeSTL::move(middle, last, first);
+			return selfmadeSTL::move_backward(buffer, buffer_end, last);
+		}
+		rotate(first, middle, last);
+		advance(first, len2);
+		return first;
+	}
+
+	// the part that fits in the buffer is moved out and merged back,
+	// a merge too large for the buffer is cut in two as __merge_without_buffer does
+	//! O(n) when the smaller part fits in the buffer
+	template <typename BidirectionalIterator, typename Distance, typename Pointer, typename Compare>
+	void __merge_adaptive(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last,
+		Distance len1, Distance len2, Pointer buffer, Distance buffer_size, Compare comp) {
+		if (len1 <= len2 && len1 <= buffer_size) {
+			Pointer buffer_end = selfmadeSTL::move(first, middle, buffer);
+			__move_merge_forward(buffer, buffer_end, middle, last, first, comp);
+		}
+		else if (len2 <= buffer_size) {
+			Pointer buffer_end = selfmadeSTL::move(middle, last, buffer);
+			__move_merge_backward(first, middle, buffer, buffer_end, last, comp);
+		}
+		else {
+			BidirectionalIterator first_cut = first;
+			BidirectionalIterator second_cut = middle;
+			Distance len11 = 0;
+			Distance len22 = 0;
+			if (len1 > len2) {
+				len11 = len1 / 2;
+				advance(first_cut, len11);
+				second_cut = lower_bound(middle, last, *first_cut, comp);
+				len22 = distance(middle, second_cut);
+			}
+			else {
+				len22 = len2 / 2;
+				advance(second_cut, len22);
+				first_cut = upper_bound(first, middle, *second_cut, comp);
+				len11 = distance(first, first_cut);
+			}
+			BidirectionalIterator new_middle = __rotate_adaptive(first_cut, middle, second_cut,
+				len1 - len11, len22, buffer, buffer_size);
+			__merge_adaptive(first, first_cut, new_middle, len11, len22, buffer, buffer_size, comp);
+			__merge_adaptive(new_middle, second_cut, last, len1 - len11, len2 - len22, buffer, buffer_size, comp);
+		}
+	}
+
 	template <typename BidirectionalIterator, typename T, typename Distance, typename Compare>
 	inline void __inplace_merge(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last, T*, Distance*, Compare comp) {
 		Distance len1 = distance(first, middle);
 		Distance len2 = distance(middle, last);
 
-		__merge_without_buffer(first, middle, last, len1, len2, comp);
+		// the smaller part is all a merge needs in the buffer
+		__temporary_buffer<BidirectionalIterator, T> buffer(first, min(len1, len2));
+		if (buffer.begin() == 0) {
+			__merge_without_buffer(first, middle, last, len1, len2, comp);
+		}
+		else {
+			__merge_adaptive(first, middle, last, len1, len2, buffer.begin(), Distance(buffer.size()), comp);
+		}
 	}
 
+	// merge the sorted [first, middle) and [middle, last), the merge is stable
+	//! O(n) with a buffer, O(nlogn) without
+	template <typename BidirectionalIterator>
+	inline void inplace_merge(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last) {
+		typedef typename iterator_traits<BidirectionalIterator>::value_type T;
+		if (first == middle || middle == last) {
+			return;
+		}
+		__inplace_merge(first, middle, last, value_type(first), difference_type(first), less<T>());
+	}
+
+	//! O(n) with a buffer, O(nlogn) without
 	template <typename BidirectionalIterator, typename Compare>
 	inline void inplace_merge(BidirectionalIterator first, BidirectionalIterator middle, BidirectionalIterator last, Compare comp) {
 		if (first == middle || middle == last) {
@@ -2358,6 +3297,139 @@ namespace selfmadeSTL {
 		}
 	}
 
+
+	//! stable sort !//
+
+	// runs of this size are sorted by insertion before the merges begin
+	const ptrdiff_t stable_sort_chunk_size = 7;
+
+	// merge [first1, last1) and [first2, last2) into another range
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator, typename Compare>
+	OutputIterator __move_merge(InputIterator first1, InputIterator last1, InputIterator first2,
+		InputIterator last2, OutputIterator result, Compare comp) {
+		while (first1 != last1 && first2 != last2) {
+			if (comp(*first2, *first1)) {
+				*result = std::move(*first2);
+				++first2;
+			}
+			else {
+				*result = std::move(*first1);
+				++first1;
+			}
+			++result;
+		}
+		result = selfmadeSTL::move(first1, last1, result);
+		return selfmadeSTL::move(first2, last2, result);
+	}
+
+	//! O(n * chunk_size)
+	template <typename RandomAccessIterator, typename Distance, typename Compare>
+	void __chunk_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Distance chunk_size, Compare comp) {
+		while (last - first >= chunk_size) {
+			__insertion_sort(first, first + chunk_size, comp);
+			first += chunk_size;
+		}
+		__insertion_sort(first, last, comp);
+	}
+
+	// merge each two runs of step elements into result
+	//! O(n)
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Distance, typename Compare>
+	void __merge_sort_loop(RandomAccessIterator1 first, RandomAccessIterator1 last, RandomAccessIterator2 result,
+		Distance step, Compare comp) {
+		const Distance two_step = 2 * step;
+		while (last - first >= two_step) {
+			result = __move_merge(first, first + step, first + step, first + two_step, result, comp);
+			first += two_step;
+		}
+		step = min(Distance(last - first), step);
+		__move_merge(first, first + step, first + step, last, result, comp);
+	}
+
+	// bottom-up merge sort, the runs go to the buffer and back,
+	// which is at least as long as the range
+	//! O(nlogn)
+	template <typename RandomAccessIterator, typename Pointer, typename Compare>
+	void __merge_sort_with_buffer(RandomAccessIterator first, RandomAccessIterator last, Pointer buffer, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		const Distance len = last - first;
+		const Pointer buffer_last = buffer + len;
+
+		Distance step = stable_sort_chunk_size;
+		__chunk_insertion_sort(first, last, step, comp);
+		while (step < len) {
+			__merge_sort_loop(first, last, buffer, step, comp);
+			step *= 2;
+			__merge_sort_loop(buffer, buffer_last, first, step, comp);
+			step *= 2;
+		}
+	}
+
+	// each half is sorted through the buffer when it fits, then the halves
+	// are merged with the buffer, a buffer of half the range is enough
+	//! O(nlogn)
+	template <typename RandomAccessIterator, typename Pointer, typename Distance, typename Compare>
+	void __stable_sort_adaptive(RandomAccessIterator first, RandomAccessIterator last, Pointer buffer,
+		Distance buffer_size, Compare comp) {
+		const Distance len = (last - first + 1) / 2;
+		const RandomAccessIterator middle = first + len;
+		if (len > buffer_size) {
+			__stable_sort_adaptive(first, middle, buffer, buffer_size, comp);
+			__stable_sort_adaptive(middle, last, buffer, buffer_size, comp);
+		}
+		else {
+			__merge_sort_with_buffer(first, middle, buffer, comp);
+			__merge_sort_with_buffer(middle, last, buffer, comp);
+		}
+		__merge_adaptive(first, middle, last, Distance(middle - first), Distance(last - middle), buffer, buffer_size, comp);
+	}
+
+	// for the case no buffer can be got
+	//! O(nlog^2n)
+	template <typename RandomAccessIterator, typename Compare>
+	void __inplace_stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		if (last - first < 15) {
+			__insertion_sort(first, last, comp);
+			return;
+		}
+		RandomAccessIterator middle = first + (last - first) / 2;
+		__inplace_stable_sort(first, middle, comp);
+		__inplace_stable_sort(middle, last, comp);
+		__merge_without_buffer(first, middle, last, middle - first, last - middle, comp);
+	}
+
+	template <typename RandomAccessIterator, typename T, typename Distance, typename Compare>
+	inline void __stable_sort(RandomAccessIterator first, RandomAccessIterator last, T*, Distance*, Compare comp) {
+		__temporary_buffer<RandomAccessIterator, T> buffer(first, (last - first + 1) / 2);
+		if (buffer.begin() == 0) {
+			__inplace_stable_sort(first, last, comp);
+		}
+		else {
+			__stable_sort_adaptive(first, last, buffer.begin(), Distance(buffer.size()), comp);
+		}
+	}
+
+	// sort that keeps the order of equal elements
+	//! O(nlogn) with a buffer, O(nlog^2n) without
+	template <typename RandomAccessIterator>
+	inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		if (first == last) {
+			return;
+		}
+		__stable_sort(first, last, value_type(first), difference_type(first), less<T>());
+	}
+
+	//! O(nlogn) with a buffer, O(nlog^2n) without
+	template <typename RandomAccessIterator, typename Compare>
+	inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		if (first == last) {
+			return;
+		}
+		__stable_sort(first, last, value_type(first), difference_type(first), comp);
+	}
+
 }
 
 #endif // !_ALGORITHM_H_
\ No newline at end of file
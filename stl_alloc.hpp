@@ -1,43 +1,299 @@
 #ifndef _ALLOC_H_
 #define _ALLOC_H_
 
+#include <atomic>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <new>
+#include <type_traits>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef __STL_USE_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+#ifdef __STL_USE_TCMALLOC
+#include <gperftools/tcmalloc.h>
+#endif
+#ifdef __linux__
+#include <cstdint>
+#include <sys/mman.h>
+#endif
 
 #include "stl_construct.hpp"
 
+// define __STL_ALLOC_STATS to count the operations of the memory pool,
+// otherwise the counters are not compiled at all
+#ifdef __STL_ALLOC_STATS
+#define __STL_ALLOC_STAT(statement) statement
+#else
+#define __STL_ALLOC_STAT(statement)
+#endif
+
 namespace selfmadeSTL {
 
+	// backends of the primary space allocator
+	// a backend gives allocate, reallocate, deallocate (sized free),
+	// allocate_aligned and deallocate_aligned, return nullptr if it fails
+
+	// C runtime
+	struct malloc_backend {
+		static void* allocate(size_t n) {
+			return malloc(n);
+		}
+		static void* reallocate(void* ptr, size_t, size_t new_size) {
+			return realloc(ptr, new_size);
+		}
+		static void deallocate(void* ptr, size_t) {
+			free(ptr);
+		}
+		// alignment is a power of 2 and a multiply of sizeof(void*)
+		static void* allocate_aligned(size_t n, size_t alignment) {
+#ifdef _WIN32
+			return _aligned_malloc(n, alignment);
+#else
+			void* space = nullptr;
+			if (posix_memalign(&space, alignment, n) != 0)
+				return nullptr;
+			return space;
+#endif
+		}
+		static void deallocate_aligned(void* ptr, size_t, size_t) {
+#ifdef _WIN32
+			_aligned_free(ptr);
+#else
+			free(ptr);
+#endif
+		}
+	};
+
+#ifdef __STL_USE_JEMALLOC
+	// jemalloc, sized deallocation by sdallocx
+	struct jemalloc_backend {
+		static void* allocate(size_t n) {
+			return mallocx(n != 0 ? n : 1, 0);
+		}
+		static void* reallocate(void* ptr, size_t, size_t new_size) {
+			return rallocx(ptr, new_size != 0 ? new_size : 1, 0);
+		}
+		static void deallocate(void* ptr, size_t n) {
+			if (ptr != nullptr)
+				sdallocx(ptr, n != 0 ? n : 1, 0);
+		}
+		static void* allocate_aligned(size_t n, size_t alignment) {
+			return mallocx(n != 0 ? n : 1, MALLOCX_ALIGN(alignment));
+		}
+		static void deallocate_aligned(void* ptr, size_t n, size_t alignment) {
+			if (ptr != nullptr)
+				sdallocx(ptr, n != 0 ? n : 1, MALLOCX_ALIGN(alignment));
+		}
+	};
+#endif
+
+#ifdef __STL_USE_TCMALLOC
+	// tcmalloc of gperftools, sized deallocation by tc_free_sized
+	struct tcmalloc_backend {
+		static void* allocate(size_t n) {
+			return tc_malloc(n);
+		}
+		static void* reallocate(void* ptr, size_t, size_t new_size) {
+			return tc_realloc(ptr, new_size);
+		}
+		static void deallocate(void* ptr, size_t n) {
+			tc_free_sized(ptr, n);
+		}
+		static void* allocate_aligned(size_t n, size_t alignment) {
+			void* space = nullptr;
+			if (tc_posix_memalign(&space, alignment, n) != 0)
+				return nullptr;
+			return space;
+		}
+		static void deallocate_aligned(void* ptr, size_t, size_t) {
+			tc_free(ptr);
+		}
+	};
+#endif
+
+	// define __STL_USE_JEMALLOC or __STL_USE_TCMALLOC to choose the backend
+	// of malloc_alloc and of the chunks of the memory pool
+#if defined(__STL_USE_JEMALLOC)
+	typedef jemalloc_backend default_malloc_backend;
+#elif defined(__STL_USE_TCMALLOC)
+	typedef tcmalloc_backend default_malloc_backend;
+#else
+	typedef malloc_backend default_malloc_backend;
+#endif
+
+#ifdef __linux__
+	// 2 MiB aligned regions of mmap, marked by madvise(MADV_HUGEPAGE)
+	// so that the kernel backs them by huge pages and a few TLB entries cover them
+	// small requests are cut from the current region by bumping, a region is
+	// unmapped when all requests cut from it are freed and it is not the current one,
+	// requests larger than a region are mapped one by one
+	// for long living chunks of the memory pool, not for general use
+	struct hugepage_backend {
+		enum {_HUGE_PAGE = 2 * 1024 * 1024};
+		enum {_ALIGN = alignof(std::max_align_t)};
+
+		// in front of every region
+		struct alignas(std::max_align_t) region_header {
+			// bytes cut from the region, the header included
+			size_t used;
+			// requests not yet freed
+			size_t live;
+		};
+		enum {_MAX_CUT = _HUGE_PAGE - sizeof(region_header)};
+
+		static size_t Round_Up(size_t bytes, size_t align) {
+			return (bytes + align - 1) & ~(align - 1);
+		}
+
+		// bytes is a multiply of _HUGE_PAGE
+		static void* map_region(size_t bytes) {
+			// map one huge page more and cut the unaligned ends
+			char* space = (char*)mmap(nullptr, bytes + _HUGE_PAGE, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (space == MAP_FAILED)
+				return nullptr;
+			char* aligned = (char*)Round_Up((uintptr_t)space, _HUGE_PAGE);
+			if (aligned != space)
+				munmap(space, aligned - space);
+			munmap(aligned + bytes, space + _HUGE_PAGE - aligned);
+#ifdef MADV_HUGEPAGE
+			madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+			return aligned;
+		}
+		static void unmap_region(void* ptr, size_t bytes) {
+			munmap(ptr, Round_Up(bytes, _HUGE_PAGE));
+		}
+
+		static region_header*& current() {
+			static region_header* region = nullptr;
+			return region;
+		}
+		static std::mutex& region_lock() {
+			static std::mutex lock;
+			return lock;
+		}
+
+		static void* allocate(size_t n) {
+			n = Round_Up(n, _ALIGN);
+			if (n > _MAX_CUT)
+				return map_region(Round_Up(n, _HUGE_PAGE));
+
+			std::lock_guard<std::mutex> guard(region_lock());
+			region_header*& region = current();
+			if (region == nullptr || _HUGE_PAGE - region->used < n) {
+				region_header* fresh = (region_header*)map_region(_HUGE_PAGE);
+				if (fresh == nullptr)
+					return nullptr;
+				fresh->used = sizeof(region_header);
+				fresh->live = 0;
+				// nothing in the old region is alive
+				if (region != nullptr && region->live == 0)
+					unmap_region(region, _HUGE_PAGE);
+				region = fresh;
+			}
+			char* result = (char*)region + region->used;
+			region->used += n;
+			++region->live;
+			return result;
+		}
+		static void deallocate(void* ptr, size_t n) {
+			if (ptr == nullptr)
+				return;
+			n = Round_Up(n, _ALIGN);
+			if (n > _MAX_CUT) {
+				unmap_region(ptr, n);
+				return;
+			}
+
+			std::lock_guard<std::mutex> guard(region_lock());
+			region_header* region = (region_header*)((uintptr_t)ptr & ~(uintptr_t)(_HUGE_PAGE - 1));
+			if (--region->live == 0 && region != current())
+				unmap_region(region, _HUGE_PAGE);
+		}
+		static void* reallocate(void* ptr, size_t old_size, size_t new_size) {
+			void* result = allocate(new_size);
+			if (result != nullptr && ptr != nullptr) {
+				memcpy(result, ptr, old_size < new_size ? old_size : new_size);
+				deallocate(ptr, old_size);
+			}
+			return result;
+		}
+		// alignment up to a huge page
+		static void* allocate_aligned(size_t n, size_t alignment) {
+			if (alignment <= _ALIGN)
+				return allocate(n);
+			if (alignment > _HUGE_PAGE)
+				return nullptr;
+			return map_region(Round_Up(n, _HUGE_PAGE));
+		}
+		static void deallocate_aligned(void* ptr, size_t n, size_t alignment) {
+			if (alignment <= _ALIGN)
+				deallocate(ptr, n);
+			else if (ptr != nullptr)
+				unmap_region(ptr, n);
+		}
+	};
+#else
+	// no mmap, chunks come from malloc
+	typedef malloc_backend hugepage_backend;
+#endif
+
+	// define __STL_USE_HUGEPAGE to cut the chunks of the memory pool from huge pages
+#ifdef __STL_USE_HUGEPAGE
+	typedef hugepage_backend default_chunk_backend;
+#else
+	typedef default_malloc_backend default_chunk_backend;
+#endif
+
 	// primary space allocator
-	template <int inst>
+	template <int inst, typename Backend = default_malloc_backend>
 	class __malloc_alloc_template {
 	private:
 		// oom = out of memory
 		static void *__oom_malloc(size_t);
-		static void *__oom_realloc(void*, size_t);
+		static void *__oom_realloc(void*, size_t, size_t);
+		static void *__oom_aligned(size_t, size_t);
 		// function pointer
 		static void (*__malloc_alloc_oom_handler)();
 
 	public:
 		static void* allocate(size_t n) {
-			void *space = malloc(n);
+			void *space = Backend::allocate(n);
 			if (space == nullptr)
 				space = __oom_malloc(n);
 			return space;
 		}
 
 		static void deallocate(void* ptr, size_t n) {
-			::operator delete(ptr);
+			Backend::deallocate(ptr, n);
 		}
 
-		static void reallocate(void* ptr, size_t old_size, size_t new_size) {
-			void* space = realloc(ptr, new_size);
+		static void* reallocate(void* ptr, size_t old_size, size_t new_size) {
+			void* space = Backend::reallocate(ptr, old_size, new_size);
 			if (space == nullptr)
-				space = __oom_realloc(ptr, new_size);
+				space = __oom_realloc(ptr, old_size, new_size);
 			return space;
 		}
 
+		// alignment is a power of 2 and a multiply of sizeof(void*)
+		static void* allocate_aligned(size_t n, size_t alignment) {
+			void* space = Backend::allocate_aligned(n, alignment);
+			if (space == nullptr)
+				space = __oom_aligned(n, alignment);
+			return space;
+		}
+
+		static void deallocate_aligned(void* ptr, size_t n, size_t alignment) {
+			Backend::deallocate_aligned(ptr, n, alignment);
+		}
+
 		static void (*__set_malloc_handler(void (*f)()))() {
 			void (*__old)() = __malloc_alloc_oom_handler;
 			__malloc_alloc_oom_handler = f;
@@ -45,11 +301,11 @@ namespace selfmadeSTL {
 		}
 	};
 
-	template <int inst>
-	void (*__malloc_alloc_template<inst>::__malloc_alloc_oom_handler)() = 0;
+	template <int inst, typename Backend>
+	void (*__malloc_alloc_template<inst, Backend>::__malloc_alloc_oom_handler)() = 0;
 
-	template <int inst>
-	void* __malloc_alloc_template<inst>::__oom_malloc(size_t n) {
+	template <int inst, typename Backend>
+	void* __malloc_alloc_template<inst, Backend>::__oom_malloc(size_t n) {
 		void (*malloc_handler)();
 		void* space;
 
@@ -62,14 +318,14 @@ namespace selfmadeSTL {
 			// free
 			(*malloc_handler)();
 			// malloc
-			space = malloc(n);
+			space = Backend::allocate(n);
 			if (space != nullptr)
 				return space;
 		}
 	}
 
-	template <int inst>
-	void* __malloc_alloc_template<inst>::__oom_realloc(void* ptr, size_t n) {
+	template <int inst, typename Backend>
+	void* __malloc_alloc_template<inst, Backend>::__oom_realloc(void* ptr, size_t old_size, size_t n) {
 		void (*malloc_handler)();
 		void* space;
 
@@ -82,7 +338,27 @@ namespace selfmadeSTL {
 			// free
 			(*malloc_handler)();
 			// malloc
-			space = realloc(ptr, n);
+			space = Backend::reallocate(ptr, old_size, n);
+			if (space != nullptr)
+				return space;
+		}
+	}
+
+	template <int inst, typename Backend>
+	void* __malloc_alloc_template<inst, Backend>::__oom_aligned(size_t n, size_t alignment) {
+		void (*malloc_handler)();
+		void* space;
+
+		while (true) {
+			malloc_handler = __malloc_alloc_oom_handler;
+			if (malloc_handler == 0) {
+				std::cerr << "Out of memory.\n";
+				exit(1);
+			}
+			// free
+			(*malloc_handler)();
+			// malloc
+			space = Backend::allocate_aligned(n, alignment);
 			if (space != nullptr)
 				return space;
 		}
@@ -108,27 +384,254 @@ namespace selfmadeSTL {
 		static void deallocate(T* __p) {
 			_Alloc::deallocate(__p, sizeof(T));
 		}
+		static T* reallocate(T* __p, size_t __old_n, size_t __new_n) {
+			if (0 == __old_n)
+				return allocate(__new_n);
+			if (0 == __new_n) {
+				deallocate(__p, __old_n);
+				return 0;
+			}
+			return static_cast<T*>(_Alloc::reallocate(__p, __old_n * sizeof(T), __new_n * sizeof(T)));
+		}
+
+		// through an allocator instance, for containers that keep one
+		static T* allocate(const _Alloc& __a, size_t __n) {
+			return 0 == __n ? 0 : static_cast<T*>(__a.allocate(__n * sizeof(T)));
+		}
+		static T* allocate(const _Alloc& __a) {
+			return static_cast<T*>(__a.allocate(sizeof(T)));
+		}
+		static void deallocate(const _Alloc& __a, T* __p, size_t __n) {
+			if (0 != __n)
+				__a.deallocate(__p, __n * sizeof(T));
+		}
+		static void deallocate(const _Alloc& __a, T* __p) {
+			__a.deallocate(__p, sizeof(T));
+		}
+		static T* reallocate(const _Alloc& __a, T* __p, size_t __old_n, size_t __new_n) {
+			if (0 == __old_n)
+				return allocate(__a, __new_n);
+			if (0 == __new_n) {
+				deallocate(__a, __p, __old_n);
+				return 0;
+			}
+			return static_cast<T*>(__a.reallocate(__p, __old_n * sizeof(T), __new_n * sizeof(T)));
+		}
 	};
 
+	// how a container treats its allocator
+	// an allocator may define propagate_on_container_copy_assignment,
+	// propagate_on_container_move_assignment and propagate_on_container_swap
+	// as __true_type to be taken along, they are __false_type if not defined
+	// an allocator without state (all static ones) is always equal to another one
+
+	template <typename T, typename = void>
+	struct __propagate_on_copy { typedef __false_type type; };
+	template <typename T>
+	struct __propagate_on_copy<T, std::void_t<typename T::propagate_on_container_copy_assignment>> {
+		typedef typename T::propagate_on_container_copy_assignment type;
+	};
+
+	template <typename T, typename = void>
+	struct __propagate_on_move { typedef __false_type type; };
+	template <typename T>
+	struct __propagate_on_move<T, std::void_t<typename T::propagate_on_container_move_assignment>> {
+		typedef typename T::propagate_on_container_move_assignment type;
+	};
+
+	template <typename T, typename = void>
+	struct __propagate_on_swap { typedef __false_type type; };
+	template <typename T>
+	struct __propagate_on_swap<T, std::void_t<typename T::propagate_on_container_swap>> {
+		typedef typename T::propagate_on_container_swap type;
+	};
+
+	template <typename Alloc>
+	struct __alloc_traits {
+		typedef typename __propagate_on_copy<Alloc>::type propagate_on_container_copy_assignment;
+		typedef typename __propagate_on_move<Alloc>::type propagate_on_container_move_assignment;
+		typedef typename __propagate_on_swap<Alloc>::type propagate_on_container_swap;
+		// a container is trivially relocatable if its allocator is
+		typedef typename std::conditional<std::is_empty<Alloc>::value,
+			__true_type, typename is_trivially_relocatable<Alloc>::type>::type is_trivially_relocatable;
+
+		static bool equal(const Alloc& a, const Alloc& b) {
+			if constexpr (std::is_empty<Alloc>::value) {
+				return true;
+			}
+			else {
+				return a == b;
+			}
+		}
+	};
+
+	// the allocator instance of a container, as a base class of it
+	// an empty allocator is not stored, so it adds no byte to the container,
+	// a new instance is made when it is needed
+	// the members of an allocator are not visible in the container
+
+	template <typename Alloc, bool = std::is_empty<Alloc>::value>
+	class __alloc_holder {
+	protected:
+		__alloc_holder() {}
+		__alloc_holder(const Alloc&) {}
+
+		Alloc get_alloc() const { return Alloc(); }
+		bool equal_alloc(const __alloc_holder&) const { return true; }
+		bool copy_assign_changes_alloc(const __alloc_holder&) const { return false; }
+		bool move_assign_takes_space(const __alloc_holder&) const { return true; }
+		void copy_assign_alloc(const __alloc_holder&) {}
+		void move_assign_alloc(__alloc_holder&) {}
+		void swap_alloc(__alloc_holder&) {}
+	};
+
+	template <typename Alloc>
+	class __alloc_holder<Alloc, false> {
+	private:
+		typedef __alloc_traits<Alloc> traits;
+
+		Alloc alloc_instance;
+
+		void assign_alloc(const __alloc_holder& other, __true_type) { alloc_instance = other.alloc_instance; }
+		void assign_alloc(const __alloc_holder&, __false_type) {}
+
+		void swap_alloc(__alloc_holder& other, __true_type) {
+			Alloc temp = alloc_instance;
+			alloc_instance = other.alloc_instance;
+			other.alloc_instance = temp;
+		}
+		void swap_alloc(__alloc_holder&, __false_type) {}
+
+	protected:
+		__alloc_holder() : alloc_instance() {}
+		__alloc_holder(const Alloc& a) : alloc_instance(a) {}
+
+		const Alloc& get_alloc() const { return alloc_instance; }
+		bool equal_alloc(const __alloc_holder& other) const {
+			return traits::equal(alloc_instance, other.alloc_instance);
+		}
+		// the space allocated before copy_assign_alloc() can not be kept
+		bool copy_assign_changes_alloc(const __alloc_holder& other) const {
+			return std::is_same<typename traits::propagate_on_container_copy_assignment, __true_type>::value &&
+				!equal_alloc(other);
+		}
+		// the space of other can be taken by move assignment
+		bool move_assign_takes_space(const __alloc_holder& other) const {
+			return std::is_same<typename traits::propagate_on_container_move_assignment, __true_type>::value ||
+				equal_alloc(other);
+		}
+
+		// the containers call them after the old space is given back
+		void copy_assign_alloc(const __alloc_holder& other) {
+			assign_alloc(other, typename traits::propagate_on_container_copy_assignment());
+		}
+		void move_assign_alloc(__alloc_holder& other) {
+			assign_alloc(other, typename traits::propagate_on_container_move_assignment());
+		}
+		// allocators that are not swapped must be equal
+		void swap_alloc(__alloc_holder& other) {
+			swap_alloc(other, typename traits::propagate_on_container_swap());
+		}
+	};
+
+
+	// size classes of the secondary space allocator
+	// a policy gives
+	// align: every block size is a multiply of it, at least a pointer
+	// max_bytes: the max size of small block
+	// nfreelists: number of free lists
+	// nobjs: number of blocks got by one refill
+	// index(bytes): the free list for a block of `bytes`
+	// size(index): the block size of a free list
+
+	// the same spacing for all free lists
+	template <size_t Align = 8, size_t MaxBytes = 128, int NObjs = 20>
+	struct uniform_size_class {
+		static_assert(Align >= sizeof(void*) && (Align & (Align - 1)) == 0, "align must be a power of 2 and hold a pointer");
+		static_assert(MaxBytes % Align == 0, "max_bytes must be a multiply of align");
+
+		enum {align = Align};
+		enum {max_bytes = MaxBytes};
+		enum {nfreelists = MaxBytes / Align};
+		enum {nobjs = NObjs};
+
+		static size_t index(size_t bytes) {
+			return (bytes + Align - 1) / Align - 1;
+		}
+		static size_t size(size_t index) {
+			return (index + 1) * Align;
+		}
+	};
+
+	// 8 bytes spacing up to 64 bytes, then 4 free lists for every power of 2
+	// 8, 16, ..., 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, ...
+	constexpr size_t __geometric_index(size_t bytes) {
+		if (bytes <= 64) {
+			return (bytes + 7) / 8 - 1;
+		}
+		// bytes in (2^k, 2^(k + 1)]
+		size_t k = 0;
+		while (((bytes - 1) >> (k + 1)) != 0) {
+			++k;
+		}
+		return 8 + (k - 6) * 4 + ((bytes - 1) >> (k - 2)) - 4;
+	}
+
+	template <size_t MaxBytes = 256, int NObjs = 20>
+	struct geometric_size_class {
+		static_assert(MaxBytes >= 64 && (MaxBytes & (MaxBytes - 1)) == 0, "max_bytes must be a power of 2 no less than 64");
+
+		enum {align = 8};
+		enum {max_bytes = MaxBytes};
+		enum {nfreelists = __geometric_index(MaxBytes) + 1};
+		enum {nobjs = NObjs};
+
+		static size_t index(size_t bytes) {
+			return __geometric_index(bytes);
+		}
+		static size_t size(size_t index) {
+			if (index < 8) {
+				return (index + 1) * 8;
+			}
+			size_t k = 6 + (index - 8) / 4;
+			return ((size_t)1 << k) + (((index - 8) % 4 + 1) << (k - 2));
+		}
+	};
+
+	// 16 free lists of 8, 16, ..., 128 bytes
+	typedef uniform_size_class<> default_size_class;
 
 	// secondary space allocator
 	// apply internal interfaces for stl_allocator
 	// in responsible for memory allocation and deallocation
+	// if `threads` is true, every thread owns a cache of free lists,
+	// and batches of blocks are exchanged with a shared depot under a lock
+	// chunks of the pool are got from and given back to ChunkBackend
 
-	template <bool threads, int inst>
+	template <bool threads, int inst, typename SizeClass = default_size_class, typename ChunkBackend = default_chunk_backend>
 	class __default_alloc_template {
 	private:
 		// small block should be the multiply of 8
-		enum {_ALIGN = 8};
+		enum {_ALIGN = SizeClass::align};
 		// the max size of small block
-		enum {_MAX_BYTES = 128};
+		enum {_MAX_BYTES = SizeClass::max_bytes};
 		// number of free lists
-		enum {_NFREELISTS = _MAX_BYTES/_ALIGN};
+		enum {_NFREELISTS = SizeClass::nfreelists};
+		// number of blocks got by one refill
+		enum {_NOBJS = SizeClass::nobjs};
+		// number of blocks moved between thread cache and depot at once
+		enum {_BATCH = _NOBJS};
+		// number of batches the depot can hold for each free list
+		enum {_DEPOT_BATCHES = 64};
 		
 		// round up to be the multiply of 8
 		static size_t Round_Up(size_t bytes) {
 			return (((bytes) + _ALIGN - 1) & ~(_ALIGN - 1));
 		}
+		// round up to the block size of its free list
+		static size_t Round_Up_Class(size_t bytes) {
+			return SizeClass::size(SizeClass::index(bytes));
+		}
 
 	private:
 		union obj {
@@ -136,11 +639,11 @@ namespace selfmadeSTL {
 			char client[1];
 		};
 
-		// 16 free lists
+		// 16 free lists by default
 		static obj* volatile free_list[_NFREELISTS];
 		// use the n^th free list 
 		static size_t freelist_index(size_t bytes) {
-			return (((bytes) + _ALIGN - 1) / _ALIGN - 1);
+			return SizeClass::index(bytes);
 		}
 
 		// return an object of size n,
@@ -158,6 +661,131 @@ namespace selfmadeSTL {
 		static char* end_free;
 		static size_t heap_size;
 
+		// header in front of every chunk got from ChunkBackend
+		struct chunk_header {
+			chunk_header* next;
+			// bytes after the header
+			size_t size;
+		};
+		// all chunks owned by the pool
+		static chunk_header* chunk_list;
+		// trim() runs once freed_bytes exceeds trim_threshold
+		static size_t trim_threshold;
+		static size_t freed_bytes;
+
+	public:
+		// snapshot of the memory pool
+		// counters are 0 unless __STL_ALLOC_STATS is defined
+		struct pool_stats {
+			// size of the blocks in each free list
+			size_t block_size[_NFREELISTS];
+			// blocks waiting in each free list,
+			// blocks cached by threads are not included
+			size_t free_blocks[_NFREELISTS];
+			size_t allocate_count[_NFREELISTS];
+			size_t deallocate_count[_NFREELISTS];
+			size_t refill_count[_NFREELISTS];
+
+			// blocks larger than _MAX_BYTES go to malloc_alloc
+			size_t malloc_allocate_count;
+			size_t malloc_allocate_bytes;
+			size_t malloc_deallocate_count;
+			size_t malloc_deallocate_bytes;
+
+			// chunks got from ChunkBackend and their total bytes
+			size_t chunk_count;
+			size_t heap_size;
+			// bytes not yet cut from the current chunk
+			size_t pool_bytes;
+			// tails of chunks too small for a refill, moved to free lists
+			size_t tail_count;
+			size_t tail_bytes;
+			// bytes in free lists, and bytes handed out to users
+			// or cached by threads
+			size_t free_bytes;
+			size_t used_bytes;
+			// chunks given back to the system by trim()
+			size_t release_count;
+			size_t release_bytes;
+		};
+
+		static pool_stats stats();
+
+		// give the chunks whose blocks are all free back to the system,
+		// blocks cached by threads keep their chunks alive
+		// return the number of bytes released
+		static size_t trim();
+		// call trim() every time `bytes` bytes have been deallocated,
+		// 0 turns it off
+		static void set_trim_threshold(size_t bytes) {
+			std::unique_lock<std::mutex> guard(depot_lock, std::defer_lock);
+			if constexpr (threads) {
+				guard.lock();
+			}
+			trim_threshold = bytes != 0 ? bytes : (size_t)-1;
+			freed_bytes = 0;
+		}
+
+	private:
+#ifdef __STL_ALLOC_STATS
+		// counters are shared by all threads in multi-thread mode
+		typedef typename std::conditional<threads, std::atomic<size_t>, size_t>::type counter;
+		struct pool_counters {
+			counter allocate_count[_NFREELISTS];
+			counter deallocate_count[_NFREELISTS];
+			counter refill_count[_NFREELISTS];
+			counter malloc_allocate_count;
+			counter malloc_allocate_bytes;
+			counter malloc_deallocate_count;
+			counter malloc_deallocate_bytes;
+			counter chunk_count;
+			counter tail_count;
+			counter tail_bytes;
+			counter release_count;
+			counter release_bytes;
+		};
+		static pool_counters counters;
+#endif
+
+	private:
+		// multi-thread state, only used if `threads` is true
+
+		// free lists owned by one thread
+		struct thread_cache {
+			obj* free_list[_NFREELISTS];
+			size_t length[_NFREELISTS];
+
+			thread_cache() : free_list(), length() {}
+			// give all cached blocks back when the thread exits
+			~thread_cache() {
+				for (size_t i = 0; i < _NFREELISTS; ++i) {
+					if (free_list[i] != nullptr) {
+						std::lock_guard<std::mutex> guard(depot_lock);
+						depot_release(i, free_list[i], length[i]);
+					}
+				}
+			}
+		};
+
+		static thread_cache& local_cache() {
+			static thread_local thread_cache cache;
+			return cache;
+		}
+
+		// protects the depot, the shared free lists and the chunk state
+		static std::mutex depot_lock;
+		// full batches of `_BATCH` blocks, each ends with nullptr
+		static obj* depot[_NFREELISTS][_DEPOT_BATCHES];
+		static size_t depot_size[_NFREELISTS];
+
+		// fill an empty thread cache with a batch of size n blocks
+		// caller must not hold the lock
+		static void cache_refill(thread_cache& cache, size_t index, size_t n);
+		// give a chain of blocks to the depot, caller must hold the lock
+		static void depot_release(size_t index, obj* head, size_t count);
+		// trim() without locking
+		static size_t trim_aux();
+
 	public:
 		// allocate space
 		static void* allocate(size_t bytes);
@@ -167,46 +795,119 @@ namespace selfmadeSTL {
 			obj* volatile* my_free_list;
 
 			if (n > (size_t)_MAX_BYTES) {
+				__STL_ALLOC_STAT(++counters.malloc_deallocate_count);
+				__STL_ALLOC_STAT(counters.malloc_deallocate_bytes += n);
 				malloc_alloc::deallocate(ptr, n);
 				return;
 			}
+			__STL_ALLOC_STAT(++counters.deallocate_count[freelist_index(n)]);
+
+			if constexpr (threads) {
+				// the block may come from any thread,
+				// it simply joins the cache of the current one
+				size_t index = freelist_index(n);
+				thread_cache& cache = local_cache();
+				q->next = cache.free_list[index];
+				cache.free_list[index] = q;
+				// too many cached blocks, hand a batch to the depot
+				if (++cache.length[index] > 2 * _BATCH) {
+					obj* head = cache.free_list[index];
+					obj* tail = head;
+					for (int i = 1; i < _BATCH; ++i) {
+						tail = tail->next;
+					}
+					cache.free_list[index] = tail->next;
+					cache.length[index] -= _BATCH;
+					tail->next = nullptr;
+					std::lock_guard<std::mutex> guard(depot_lock);
+					depot_release(index, head, _BATCH);
+					if ((freed_bytes += _BATCH * Round_Up_Class(n)) > trim_threshold) {
+						trim_aux();
+					}
+				}
+				return;
+			}
 
 			my_free_list = free_list + freelist_index(n);
 			q->next = *my_free_list;
 			*my_free_list = q;
+			if ((freed_bytes += n) > trim_threshold) {
+				trim_aux();
+			}
 		}
 		// reallocate space
 		static void* reallocate(void* ptr, size_t old_size, size_t new_size);
 	};
 
-	template <bool threads, int inst>
-	char* __default_alloc_template<threads, inst>::start_free = 0;
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	char* __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::start_free = 0;
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	char* __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::end_free = 0;
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	size_t __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::heap_size = 0;
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	typename __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::chunk_header*
+	__default_alloc_template<threads, inst, SizeClass, ChunkBackend>::chunk_list = 0;
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	size_t __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::trim_threshold = (size_t)-1;
 
-	template <bool threads, int inst>
-	char* __default_alloc_template<threads, inst>::end_free = 0;
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	size_t __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::freed_bytes = 0;
 
-	template <bool threads, int inst>
-	size_t __default_alloc_template<threads, inst>::heap_size = 0;
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	typename __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::obj* volatile
+	__default_alloc_template<threads, inst, SizeClass, ChunkBackend>::free_list[_NFREELISTS] = {};
 
-	template <bool threads, int inst>
-	typename __default_alloc_template<threads, inst>::obj* volatile
-	__default_alloc_template<threads, inst>::free_list[_NFREELISTS] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+#ifdef __STL_ALLOC_STATS
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	typename __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::pool_counters
+	__default_alloc_template<threads, inst, SizeClass, ChunkBackend>::counters;
+#endif
 
-	template <bool threads, int inst>
-	void* __default_alloc_template<threads, inst>::allocate(size_t n) {
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	std::mutex __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::depot_lock;
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	typename __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::obj*
+	__default_alloc_template<threads, inst, SizeClass, ChunkBackend>::depot[_NFREELISTS][_DEPOT_BATCHES] = {};
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	size_t __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::depot_size[_NFREELISTS] = {};
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	void* __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::allocate(size_t n) {
 		obj* volatile* my_free_list;
 		obj* space;
 
 		// if more than 128
 		if (n > (size_t)_MAX_BYTES) {
+			__STL_ALLOC_STAT(++counters.malloc_allocate_count);
+			__STL_ALLOC_STAT(counters.malloc_allocate_bytes += n);
 			return (malloc_alloc::allocate(n));
 		}
+		__STL_ALLOC_STAT(++counters.allocate_count[freelist_index(n)]);
+
+		if constexpr (threads) {
+			size_t index = freelist_index(n);
+			thread_cache& cache = local_cache();
+			if (cache.free_list[index] == nullptr) {
+				cache_refill(cache, index, Round_Up_Class(n));
+			}
+			space = cache.free_list[index];
+			cache.free_list[index] = space->next;
+			--cache.length[index];
+			return space;
+		}
 
 		my_free_list = free_list + freelist_index(n);
 		space = *my_free_list;
 		if (space == nullptr) {
 			// no available free list
-			void* r = refill(Round_Up(n));
+			void* r = refill(Round_Up_Class(n));
 			return r;
 		}
 		// adjust free list
@@ -214,16 +915,266 @@ namespace selfmadeSTL {
 		return space;
 	}
 
-	template <bool threads, int inst>
-	void* __default_alloc_template<threads, inst>::reallocate(void* ptr, size_t old_size, size_t new_size) {
-		return 0;
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	void* __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::reallocate(void* ptr, size_t old_size, size_t new_size) {
+		// both are large blocks
+		if (old_size > (size_t)_MAX_BYTES && new_size > (size_t)_MAX_BYTES) {
+			return malloc_alloc::reallocate(ptr, old_size, new_size);
+		}
+		// still in the same free list
+		if (Round_Up_Class(old_size) == Round_Up_Class(new_size)) {
+			return ptr;
+		}
+		// move to another free list with one copy
+		void* result = allocate(new_size);
+		size_t copy_size = new_size > old_size ? old_size : new_size;
+		memcpy(result, ptr, copy_size);
+		deallocate(ptr, old_size);
+		return result;
+	}
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	void __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::cache_refill(thread_cache& cache, size_t index, size_t n) {
+		std::lock_guard<std::mutex> guard(depot_lock);
+
+		// take a whole batch from the depot
+		if (depot_size[index] > 0) {
+			cache.free_list[index] = depot[index][--depot_size[index]];
+			cache.length[index] = _BATCH;
+			return;
+		}
+
+		// take at most a batch from the shared free list
+		obj* volatile* my_free_list = free_list + index;
+		if (*my_free_list != nullptr) {
+			obj* head = *my_free_list;
+			obj* tail = head;
+			size_t count = 1;
+			for (; count < _BATCH && tail->next != nullptr; ++count) {
+				tail = tail->next;
+			}
+			*my_free_list = tail->next;
+			tail->next = nullptr;
+			cache.free_list[index] = head;
+			cache.length[index] = count;
+			return;
+		}
+
+		// cut a new batch from the memory pool
+		__STL_ALLOC_STAT(++counters.refill_count[index]);
+		int nobjs = _BATCH;
+		char* chunk = chunk_alloc(n, nobjs);
+		obj* current_obj = (obj*)chunk;
+		for (int i = 1; i < nobjs; ++i) {
+			current_obj->next = (obj*)((char*)current_obj + n);
+			current_obj = current_obj->next;
+		}
+		current_obj->next = nullptr;
+		cache.free_list[index] = (obj*)chunk;
+		cache.length[index] = nobjs;
+	}
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	void __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::depot_release(size_t index, obj* head, size_t count) {
+		// keep full batches so they can be handed out in O(1)
+		if (count == _BATCH && depot_size[index] < _DEPOT_BATCHES) {
+			depot[index][depot_size[index]++] = head;
+			return;
+		}
+		// otherwise link the chain to the shared free list
+		obj* tail = head;
+		while (tail->next != nullptr) {
+			tail = tail->next;
+		}
+		obj* volatile* my_free_list = free_list + index;
+		tail->next = *my_free_list;
+		*my_free_list = head;
 	}
 
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	auto __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::stats() -> pool_stats {
+		pool_stats result = {};
+		std::unique_lock<std::mutex> guard(depot_lock, std::defer_lock);
+		if constexpr (threads) {
+			guard.lock();
+		}
+
+		for (size_t i = 0; i < _NFREELISTS; ++i) {
+			result.block_size[i] = SizeClass::size(i);
+			size_t depth = 0;
+			for (obj* p = free_list[i]; p != nullptr; p = p->next) {
+				++depth;
+			}
+			if constexpr (threads) {
+				depth += depot_size[i] * _BATCH;
+			}
+			result.free_blocks[i] = depth;
+			result.free_bytes += depth * result.block_size[i];
+		}
+		result.heap_size = heap_size;
+		result.pool_bytes = end_free - start_free;
+		result.used_bytes = heap_size - result.pool_bytes - result.free_bytes;
+
+#ifdef __STL_ALLOC_STATS
+		for (size_t i = 0; i < _NFREELISTS; ++i) {
+			result.allocate_count[i] = counters.allocate_count[i];
+			result.deallocate_count[i] = counters.deallocate_count[i];
+			result.refill_count[i] = counters.refill_count[i];
+		}
+		result.malloc_allocate_count = counters.malloc_allocate_count;
+		result.malloc_allocate_bytes = counters.malloc_allocate_bytes;
+		result.malloc_deallocate_count = counters.malloc_deallocate_count;
+		result.malloc_deallocate_bytes = counters.malloc_deallocate_bytes;
+		result.chunk_count = counters.chunk_count;
+		result.tail_count = counters.tail_count;
+		result.tail_bytes = counters.tail_bytes;
+		result.release_count = counters.release_count;
+		result.release_bytes = counters.release_bytes;
+#endif
+		return result;
+	}
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	size_t __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::trim() {
+		std::unique_lock<std::mutex> guard(depot_lock, std::defer_lock);
+		if constexpr (threads) {
+			guard.lock();
+		}
+		return trim_aux();
+	}
+
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	size_t __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::trim_aux() {
+		// free bytes found in every chunk
+		struct chunk_record {
+			char* first;
+			char* last;
+			size_t free;
+			chunk_header* header;
+		};
+
+		freed_bytes = 0;
+		size_t chunk_num = 0;
+		for (chunk_header* h = chunk_list; h != nullptr; h = h->next) {
+			++chunk_num;
+		}
+		if (chunk_num == 0) {
+			return 0;
+		}
+
+		// blocks in the depot are checked as part of the shared free lists
+		if constexpr (threads) {
+			for (size_t i = 0; i < _NFREELISTS; ++i) {
+				while (depot_size[i] > 0) {
+					depot_release(i, depot[i][--depot_size[i]], 0);
+				}
+			}
+		}
+
+		chunk_record* records = (chunk_record*)malloc(chunk_num * sizeof(chunk_record));
+		if (records == nullptr) {
+			return 0;
+		}
+		chunk_record* rec = records;
+		for (chunk_header* h = chunk_list; h != nullptr; h = h->next, ++rec) {
+			rec->first = (char*)(h + 1);
+			rec->last = rec->first + h->size;
+			rec->free = 0;
+			rec->header = h;
+		}
+		// sort by address, then search the owner of a block by bisection
+		qsort(records, chunk_num, sizeof(chunk_record), [](const void* a, const void* b) {
+			char* x = ((const chunk_record*)a)->first;
+			char* y = ((const chunk_record*)b)->first;
+			return x < y ? -1 : (y < x ? 1 : 0);
+		});
+		auto owner = [records, chunk_num](char* p) -> chunk_record* {
+			size_t low = 0, high = chunk_num;
+			while (high - low > 1) {
+				size_t mid = (low + high) / 2;
+				if (p < records[mid].first) {
+					high = mid;
+				}
+				else {
+					low = mid;
+				}
+			}
+			return records + low;
+		};
+
+		// the uncut part of the pool is free
+		if (start_free != end_free) {
+			owner(start_free)->free += end_free - start_free;
+		}
+		for (size_t i = 0; i < _NFREELISTS; ++i) {
+			for (obj* p = free_list[i]; p != nullptr; p = p->next) {
+				owner((char*)p)->free += SizeClass::size(i);
+			}
+		}
+
+		// unlink the blocks of idle chunks from the free lists
+		size_t released = 0;
+		for (size_t i = 0; i < chunk_num; ++i) {
+			if (records[i].free == records[i].header->size) {
+				released += records[i].free;
+			}
+		}
+		if (released == 0) {
+			free(records);
+			return 0;
+		}
+		for (size_t i = 0; i < _NFREELISTS; ++i) {
+			obj* volatile* link = free_list + i;
+			while (*link != nullptr) {
+				chunk_record* r = owner((char*)*link);
+				if (r->free == r->header->size) {
+					*link = (*link)->next;
+				}
+				else {
+					link = &(*link)->next;
+				}
+			}
+		}
+		if (start_free != end_free) {
+			chunk_record* r = owner(start_free);
+			if (r->free == r->header->size) {
+				start_free = end_free = 0;
+			}
+		}
+
+		// give the idle chunks back
+		chunk_header** link = &chunk_list;
+		while (*link != nullptr) {
+			chunk_record* r = owner((char*)(*link + 1));
+			if (r->free == r->header->size) {
+				chunk_header* idle = *link;
+				*link = idle->next;
+				heap_size -= idle->size;
+				__STL_ALLOC_STAT(++counters.release_count);
+				__STL_ALLOC_STAT(counters.release_bytes += idle->size);
+				ChunkBackend::deallocate(idle, sizeof(chunk_header) + idle->size);
+			}
+			else {
+				link = &(*link)->next;
+			}
+		}
+		free(records);
+		return released;
+	}
+
+	// define __STL_USE_MALLOC to send every container to malloc_alloc
+#ifdef __STL_USE_MALLOC
+	typedef malloc_alloc alloc;
+#else
 	typedef __default_alloc_template<false, 0> alloc;
+#endif
+	// thread safe version, every thread allocates from its own cache
+	typedef __default_alloc_template<true, 0> thread_alloc;
 
-	template <bool threads, int inst>
-	void* __default_alloc_template<threads, inst>::refill(size_t n) {
-		int nobjs = 20;
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	void* __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::refill(size_t n) {
+		int nobjs = _NOBJS;
+		__STL_ALLOC_STAT(++counters.refill_count[freelist_index(n)]);
 
 		char* chunk = chunk_alloc(n, nobjs);
 		obj* volatile* my_free_list;
@@ -252,8 +1203,8 @@ namespace selfmadeSTL {
 		return space;
 	}
 
-	template <bool threads, int inst>
-	char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size, int& nobjs) {
+	template <bool threads, int inst, typename SizeClass, typename ChunkBackend>
+	char* __default_alloc_template<threads, inst, SizeClass, ChunkBackend>::chunk_alloc(size_t size, int& nobjs) {
 		char* result;
 		size_t total_bytes = size * nobjs;
 		size_t bytes_left = end_free - start_free;
@@ -277,41 +1228,240 @@ namespace selfmadeSTL {
 			size_t bytes_to_get = 2 * total_bytes + Round_Up(heap_size >> 4);
 			// Try to make use of the left-over piece.
 			if (bytes_left > 0) {
-				// search for free list
-				obj* volatile* my_free_list = free_list + freelist_index(bytes_left);
+				__STL_ALLOC_STAT(++counters.tail_count);
+				__STL_ALLOC_STAT(counters.tail_bytes += bytes_left);
+			}
+			while (bytes_left > 0) {
+				// search for the biggest free list that fits in
+				size_t index = freelist_index(bytes_left);
+				if (SizeClass::size(index) > bytes_left) {
+					--index;
+				}
+				obj* volatile* my_free_list = free_list + index;
 				((obj*)start_free)->next = *my_free_list;
 				*my_free_list = (obj*)start_free;
+				start_free += SizeClass::size(index);
+				bytes_left -= SizeClass::size(index);
 			}
 
 			// config heap space for memory pool
-			start_free = (char*)malloc(bytes_to_get);
-			if (start_free == NULL) {
+			// with a header to find the chunk in trim()
+			chunk_header* chunk = (chunk_header*)ChunkBackend::allocate(sizeof(chunk_header) + bytes_to_get);
+			if (chunk == NULL) {
 				// malloc fails
-				int i;
+				size_t i;
 				obj* volatile* my_free_list, * p;
 				// search for unused and big enough free list
-				for (i = size; i <= _MAX_BYTES; i += _ALIGN) {
-					my_free_list = free_list + freelist_index(i);
+				for (i = freelist_index(size); i < _NFREELISTS; ++i) {
+					my_free_list = free_list + i;
 					p = *my_free_list;
 					if (p != NULL) {
 						// adjust free list
 						*my_free_list = p->next;
 						start_free = (char*)p;
-						end_free = start_free + i;
+						end_free = start_free + SizeClass::size(i);
 						// adjust nobjs
 						return chunk_alloc(size, nobjs);
 					}
 				}
 				// no any space
-				end_free = NULL;
+				start_free = end_free = NULL;
 				// this will throw exception
-				start_free = (char*)malloc_alloc::allocate(bytes_to_get);
+				chunk = (chunk_header*)__malloc_alloc_template<0, ChunkBackend>::allocate(sizeof(chunk_header) + bytes_to_get);
 			}
+			chunk->next = chunk_list;
+			chunk->size = bytes_to_get;
+			chunk_list = chunk;
+			start_free = (char*)(chunk + 1);
+			__STL_ALLOC_STAT(++counters.chunk_count);
 			heap_size += bytes_to_get;
 			end_free = start_free + bytes_to_get;
 			return chunk_alloc(size, nobjs);
 		}
 	}
+
+	// monotonic arena
+	// memory is cut from big blocks by bumping a pointer,
+	// deallocate does nothing and reset() makes all blocks available again in O(1)
+	// all containers using the arena must be dead or never touched again before reset(),
+	// one arena is not thread safe, give every thread its own arena
+
+	class arena {
+	private:
+		// every allocation is aligned to it
+		enum {_ALIGN = alignof(std::max_align_t)};
+		// size of the first block
+		enum {_INIT_BLOCK = 64 * 1024};
+
+		static size_t Round_Up(size_t bytes) {
+			return (((bytes) + _ALIGN - 1) & ~(size_t)(_ALIGN - 1));
+		}
+
+		// header in front of every block, keeps the alignment of the data behind
+		struct alignas(std::max_align_t) block_header {
+			block_header* next;
+			size_t size;
+		};
+
+		// all blocks, in the order they are used
+		block_header* first_block;
+		block_header* current_block;
+		// free space of the current block
+		char* start_free;
+		char* end_free;
+
+		// move to a block that has n bytes free
+		void next_block(size_t n) {
+			// reuse the blocks kept by reset()
+			size_t last_size = _INIT_BLOCK / 2;
+			if (current_block != nullptr) {
+				last_size = current_block->size;
+				while (current_block->next != nullptr) {
+					current_block = current_block->next;
+					last_size = current_block->size;
+					if (current_block->size >= n) {
+						start_free = (char*)(current_block + 1);
+						end_free = start_free + current_block->size;
+						return;
+					}
+				}
+			}
+
+			// append a new block, twice as big as the last one
+			size_t bytes_to_get = 2 * last_size > n ? 2 * last_size : n;
+			block_header* block = (block_header*)malloc_alloc::allocate(sizeof(block_header) + bytes_to_get);
+			block->next = nullptr;
+			block->size = bytes_to_get;
+			if (current_block != nullptr) {
+				current_block->next = block;
+			}
+			else {
+				first_block = block;
+			}
+			current_block = block;
+			start_free = (char*)(block + 1);
+			end_free = start_free + bytes_to_get;
+		}
+
+	public:
+		constexpr arena()
+			: first_block(nullptr), current_block(nullptr), start_free(nullptr), end_free(nullptr) {}
+
+		arena(const arena&) = delete;
+		arena& operator=(const arena&) = delete;
+
+		~arena() { release(); }
+
+		void* allocate(size_t n) {
+			n = Round_Up(n);
+			if ((size_t)(end_free - start_free) < n) {
+				next_block(n);
+			}
+			char* result = start_free;
+			start_free += n;
+			return result;
+		}
+
+		// memory is given back by reset()
+		void deallocate(void*, size_t) {}
+
+		void* reallocate(void* ptr, size_t old_size, size_t new_size) {
+			// the last allocation grows or shrinks in place
+			if ((char*)ptr + Round_Up(old_size) == start_free &&
+				(size_t)(end_free - (char*)ptr) >= new_size) {
+				start_free = (char*)ptr + Round_Up(new_size);
+				return ptr;
+			}
+			void* result = allocate(new_size);
+			memcpy(result, ptr, old_size < new_size ? old_size : new_size);
+			return result;
+		}
+
+		// forget all allocations and keep the blocks
+		void reset() {
+			current_block = first_block;
+			start_free = first_block != nullptr ? (char*)(first_block + 1) : nullptr;
+			end_free = first_block != nullptr ? start_free + first_block->size : nullptr;
+		}
+
+		// forget all allocations and give the blocks back
+		void release() {
+			while (first_block != nullptr) {
+				block_header* next = first_block->next;
+				malloc_alloc::deallocate(first_block, sizeof(block_header) + first_block->size);
+				first_block = next;
+			}
+			current_block = nullptr;
+			start_free = end_free = nullptr;
+		}
+
+		// bytes got from the system
+		size_t capacity() const {
+			size_t total = 0;
+			for (block_header* b = first_block; b != nullptr; b = b->next) {
+				total += b->size;
+			}
+			return total;
+		}
+	};
+
+	// one process wide arena for every `inst`, with the static interface of alloc
+
+	template <int inst>
+	class __arena_alloc_template {
+	private:
+		// constant initialized, so it is destroyed after every container built at run time
+		static arena pool;
+
+	public:
+		static void* allocate(size_t n) { return pool.allocate(n); }
+		static void deallocate(void* ptr, size_t n) { pool.deallocate(ptr, n); }
+		static void* reallocate(void* ptr, size_t old_size, size_t new_size) {
+			return pool.reallocate(ptr, old_size, new_size);
+		}
+		static void reset() { pool.reset(); }
+		static void release() { pool.release(); }
+		static size_t capacity() { return pool.capacity(); }
+		static arena& resource() { return pool; }
+	};
+
+	template <int inst>
+	arena __arena_alloc_template<inst>::pool;
+
+	typedef __arena_alloc_template<0> arena_alloc;
+
+	// stateful allocator of a container, every container may use its own arena
+	// copy assignment keeps the arena of the target, move assignment and swap take the arena along
+	class arena_allocator {
+	private:
+		arena* res;
+
+	public:
+		typedef __false_type propagate_on_container_copy_assignment;
+		typedef __true_type propagate_on_container_move_assignment;
+		typedef __true_type propagate_on_container_swap;
+
+		// the arena of arena_alloc
+		arena_allocator() : res(&arena_alloc::resource()) {}
+		arena_allocator(arena& r) : res(&r) {}
+
+		void* allocate(size_t n) const { return res->allocate(n); }
+		void deallocate(void* ptr, size_t n) const { res->deallocate(ptr, n); }
+		void* reallocate(void* ptr, size_t old_size, size_t new_size) const {
+			return res->reallocate(ptr, old_size, new_size);
+		}
+
+		arena* resource() const { return res; }
+
+		bool operator==(const arena_allocator& other) const { return res == other.res; }
+		bool operator!=(const arena_allocator& other) const { return res != other.res; }
+	};
+
+	// only a pointer to the arena
+	template <>
+	struct is_trivially_relocatable<arena_allocator> {
+		typedef __true_type type;
+	};
 };
 
 #endif // !_ALLOC_H_
\ No newline at end of file
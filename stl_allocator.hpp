@@ -58,6 +58,8 @@ namespace selfmadeSTL {
 		static void deallocate(pointer ptr);
 		// deallocate space for n type T objects
 		static void deallocate(pointer ptr, size_type n);
+		// resize space from old_n to new_n type T objects
+		static pointer reallocate(pointer ptr, size_type old_n, size_type new_n);
 
 		// new(const void* ptr) T(value)
 		static void construct(pointer ptr);
@@ -126,6 +128,17 @@ namespace selfmadeSTL {
 		alloc::deallocate(static_cast<void*>(ptr), sizeof(T) * n);
 	}
 
+	template <typename T>
+	auto allocator<T>::reallocate(pointer ptr, size_type old_n, size_type new_n) -> pointer {
+		if (old_n == 0)
+			return allocate(new_n);
+		if (new_n == 0) {
+			deallocate(ptr, old_n);
+			return nullptr;
+		}
+		return static_cast<pointer>(alloc::reallocate(static_cast<void*>(ptr), sizeof(T) * old_n, sizeof(T) * new_n));
+	}
+
 	template <typename T>
 	void allocator<T>::construct(pointer ptr) {
 		new(ptr)T();
@@ -147,6 +160,27 @@ namespace selfmadeSTL {
 			first->~T();
 		}
 	}
+
+	// allocator counts objects, simple_alloc counts bytes,
+	// so a container with an allocator takes its space from alloc directly
+	template <typename T, typename U>
+	class simple_alloc<T, allocator<U>> : public simple_alloc<T, alloc> {
+	private:
+		typedef simple_alloc<T, alloc> base;
+
+	public:
+		using base::allocate;
+		using base::deallocate;
+		using base::reallocate;
+
+		static T* allocate(const allocator<U>&, size_t __n) { return base::allocate(__n); }
+		static T* allocate(const allocator<U>&) { return base::allocate(); }
+		static void deallocate(const allocator<U>&, T* __p, size_t __n) { base::deallocate(__p, __n); }
+		static void deallocate(const allocator<U>&, T* __p) { base::deallocate(__p); }
+		static T* reallocate(const allocator<U>&, T* __p, size_t __old_n, size_t __new_n) {
+			return base::reallocate(__p, __old_n, __new_n);
+		}
+	};
 };
 
 #endif // !_ALLOCATOR_H_
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define _CONSTRUCT_H_
 
 #include <new>
+#include <utility>
 
 #include "stl_iterator.hpp"
 #include "stl_type_traits.hpp"
@@ -10,16 +11,12 @@ namespace selfmadeSTL {
 
 	// in responsible for construct and destruct
 
-	// construct with value
-	template <typename T1, typename T2>
-	inline void construct(T1* ptr, const T2& value) {
-		new(ptr)T1(value);
-	}
-
-	// construct without value
-	template <typename T>
-	inline void construct(T* ptr) {
-		new(ptr)T();
+	// construct in place with the arguments of a constructor of T,
+	// they are forwarded as they are given, an rvalue is moved
+	// without argument, the value is value initialized
+	template <typename T, typename... Args>
+	inline void construct(T* ptr, Args&&... args) {
+		new(ptr)T(std::forward<Args>(args)...);
 	}
 
 	// destruct, argument is a *pointer*
@@ -0,0 +1,145 @@
+#ifndef _DEBUG_H_
+#define _DEBUG_H_
+
+#include <cstdlib>
+#include <iostream>
+#include <type_traits>
+
+#include "stl_iterator.hpp"
+
+// __STL_HARDENED checks bounds and the use of empty containers
+// __STL_DEBUG checks as __STL_HARDENED does, and iterators of vector and deque
+// carry a generation of the container to find the invalidated ones, an iterator
+// of vector belongs to the space of the elements and follows it to another vector
+// without either of them, a check is nothing at all
+
+#if defined(__STL_DEBUG) && !defined(__STL_HARDENED)
+#define __STL_HARDENED
+#endif
+
+#ifdef __STL_HARDENED
+#define __STL_CHECK(cond, message) \
+	((cond) ? (void)0 : selfmadeSTL::debug_check::failed(message, __FILE__, __LINE__))
+#else
+#define __STL_CHECK(cond, message) ((void)0)
+#endif
+
+namespace selfmadeSTL {
+
+	// a failed check calls the handler if there is one, it may throw to go on,
+	// otherwise the message is printed and the program is aborted
+	template <int inst>
+	class __debug_check_template {
+	private:
+		static void (*__check_failed_handler)(const char*, const char*, int);
+
+	public:
+		static void failed(const char* message, const char* file, int line) {
+			if (__check_failed_handler != 0) {
+				__check_failed_handler(message, file, line);
+			}
+			std::cerr << "selfmadeSTL: " << message << " at " << file << ':' << line << std::endl;
+			abort();
+		}
+
+		static void (*__set_check_handler(void (*f)(const char*, const char*, int)))(const char*, const char*, int) {
+			void (*__old)(const char*, const char*, int) = __check_failed_handler;
+			__check_failed_handler = f;
+			return __old;
+		}
+	};
+
+	template <int inst>
+	void (*__debug_check_template<inst>::__check_failed_handler)(const char*, const char*, int) = 0;
+
+	typedef __debug_check_template<0> debug_check;
+
+#ifdef __STL_DEBUG
+	// the space of the elements of a Container that its iterators are checked against,
+	// owner is the container that holds the elements now, swap and move give the space
+	// to another container, the generation changes when the elements move in memory
+	template <typename Container>
+	struct __debug_space {
+		const Container* owner;
+		size_t generation;
+
+		explicit __debug_space(const Container* c) : owner(c), generation(0) {}
+	};
+
+	// an iterator over the contiguous space of Container, with the generation of the space
+	// Container gives __dereferenceable(p) to its friend
+	template <typename Ptr, typename Container>
+	class __checked_iterator {
+	public:
+		typedef random_access_iterator_tag                  iterator_category;
+		typedef typename Container::value_type              value_type;
+		typedef ptrdiff_t                                   difference_type;
+		typedef Ptr                                         pointer;
+		typedef decltype(*Ptr())                            reference;
+
+	private:
+		Ptr ptr;
+		const __debug_space<Container>* space;
+		size_t generation;
+
+	public:
+		__checked_iterator() : ptr(), space(0), generation(0) {}
+		__checked_iterator(Ptr p, const __debug_space<Container>* s) : ptr(p), space(s), generation(s->generation) {}
+		// iterator to const_iterator
+		template <typename P, typename = typename std::enable_if<std::is_convertible<P, Ptr>::value>::type>
+		__checked_iterator(const __checked_iterator<P, Container>& other)
+			: ptr(other.base()), space(other.debug_space()), generation(other.stamp()) {}
+
+		Ptr base() const { return ptr; }
+		const __debug_space<Container>* debug_space() const { return space; }
+		const Container* container() const { return space != 0 ? space->owner : 0; }
+		size_t stamp() const { return generation; }
+
+		// the space has not changed since the iterator is made
+		bool valid() const { return space != 0 && generation == space->generation; }
+
+		reference operator*() const {
+			__STL_CHECK(valid(), "invalidated iterator");
+			__STL_CHECK(space->owner->__dereferenceable(ptr), "iterator out of range");
+			return *ptr;
+		}
+		pointer operator->() const { return &operator*(); }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+		__checked_iterator& operator++() { ++ptr; return *this; }
+		__checked_iterator operator++(int) { __checked_iterator temp = *this; ++ptr; return temp; }
+		__checked_iterator& operator--() { --ptr; return *this; }
+		__checked_iterator operator--(int) { __checked_iterator temp = *this; --ptr; return temp; }
+		__checked_iterator& operator+=(difference_type n) { ptr += n; return *this; }
+		__checked_iterator& operator-=(difference_type n) { ptr -= n; return *this; }
+		__checked_iterator operator+(difference_type n) const { __checked_iterator temp = *this; return temp += n; }
+		__checked_iterator operator-(difference_type n) const { __checked_iterator temp = *this; return temp -= n; }
+
+		template <typename P>
+		difference_type operator-(const __checked_iterator<P, Container>& other) const {
+			__STL_CHECK(space == other.debug_space(), "iterators of different containers");
+			return ptr - other.base();
+		}
+
+		template <typename P>
+		bool operator==(const __checked_iterator<P, Container>& other) const { return ptr == other.base(); }
+		template <typename P>
+		bool operator!=(const __checked_iterator<P, Container>& other) const { return ptr != other.base(); }
+		template <typename P>
+		bool operator<(const __checked_iterator<P, Container>& other) const { return ptr < other.base(); }
+		template <typename P>
+		bool operator>(const __checked_iterator<P, Container>& other) const { return ptr > other.base(); }
+		template <typename P>
+		bool operator<=(const __checked_iterator<P, Container>& other) const { return ptr <= other.base(); }
+		template <typename P>
+		bool operator>=(const __checked_iterator<P, Container>& other) const { return ptr >= other.base(); }
+	};
+
+	template <typename Ptr, typename Container>
+	inline __checked_iterator<Ptr, Container> operator+(ptrdiff_t n, const __checked_iterator<Ptr, Container>& it) {
+		return it + n;
+	}
+#endif
+}
+
+#endif // !_DEBUG_H_
@@ -3,6 +3,7 @@
 
 #include "stl_algorithm.hpp"
 #include "stl_allocator.hpp"
+#include "stl_debug.hpp"
 #include "stl_iterator.hpp"
 #include "stl_type_traits.hpp"
 #include "stl_uninitialized.hpp"
@@ -38,6 +39,13 @@ namespace selfmadeSTL {
 		pointer last;
 		// current buffer
 		map_pointer node;
+#ifdef __STL_DEBUG
+		// the generation of the deque that gave the iterator out, none for an inner one
+		const size_t* owner = nullptr;
+		size_t stamp = 0;
+
+		bool valid() const { return owner == nullptr || *owner == stamp; }
+#endif
 
 		deque_iterator() :
 			curr(nullptr), first(nullptr),
@@ -45,12 +53,24 @@ namespace selfmadeSTL {
 		deque_iterator(T* pos, map_pointer map) :
 			curr(pos), first(*map),
 			last(*map + buffer_size()), node(map) {}
+#ifdef __STL_DEBUG
+		deque_iterator(const iterator& other) :
+			curr(other.curr), first(other.first),
+			last(other.last), node(other.node),
+			owner(other.owner), stamp(other.stamp) {}
+#else
 		deque_iterator(const iterator& other) :
 			curr(other.curr), first(other.first),
 			last(other.last), node(other.node) {}
+#endif
 		
-		reference operator*() const { return *curr; }
-		pointer operator->() const { return curr; }
+		reference operator*() const {
+#ifdef __STL_DEBUG
+			__STL_CHECK(valid(), "invalidated iterator");
+#endif
+			return *curr;
+		}
+		pointer operator->() const { return &operator*(); }
 		// position difference
 		// this - other
 		difference_type operator-(const deque_iterator& other) const {
@@ -110,14 +130,14 @@ namespace selfmadeSTL {
 			}
 			return *this;
 		}
-		deque_iterator operator+(difference_type n) {
+		deque_iterator operator+(difference_type n) const {
 			deque_iterator temp = *this;
 			return temp += n;
 		}
 		deque_iterator& operator-=(difference_type n) {
 			return *this += (-n);
 		}
-		deque_iterator operator-(difference_type n) {
+		deque_iterator operator-(difference_type n) const {
 			deque_iterator temp = *this;
 			return temp -= n;
 		}
@@ -153,8 +173,9 @@ namespace selfmadeSTL {
 	} 
 
 
+	// Alloc may be a static allocator or an allocator instance kept by the deque
 	template <typename T, typename Alloc = alloc, size_t BufSize = 0>
-	class deque {
+	class deque : protected __alloc_holder<Alloc> {
 	public:
 		typedef T               value_type;
 		typedef T*              pointer;
@@ -166,8 +187,10 @@ namespace selfmadeSTL {
 
 		typedef deque_iterator<T, T&, T*, BufSize> iterator;
 		typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
+		typedef Alloc           allocator_type;
 
 	protected:
+		typedef __alloc_holder<Alloc> alloc_holder;
 		typedef simple_alloc<T, Alloc> node_allocator;
 		typedef simple_alloc<T*, Alloc> map_allocator;
 		typedef pointer*                  map_pointer;
@@ -179,13 +202,42 @@ namespace selfmadeSTL {
 
 		enum class MapSize { MAP_SIZE = 8 };
 
+#ifdef __STL_DEBUG
+		// changes when the elements are moved, an iterator of another generation is invalidated
+		size_t generation = 0;
+
+		template <typename Iterator>
+		Iterator attach(Iterator it) const {
+			it.owner = &generation;
+			it.stamp = generation;
+			return it;
+		}
+
+		// an iterator given in, checked and taken as an inner one
+		template <typename Iterator>
+		Iterator detach(Iterator it) const {
+			__STL_CHECK(it.owner == nullptr || it.owner == &generation, "iterator of another container");
+			__STL_CHECK(it.valid(), "invalidated iterator");
+			it.owner = nullptr;
+			return it;
+		}
+
+		void invalidate_iterators() { ++generation; }
+#else
+		template <typename Iterator>
+		Iterator attach(Iterator it) const { return it; }
+		template <typename Iterator>
+		Iterator detach(Iterator it) const { return it; }
+		void invalidate_iterators() {}
+#endif
+
 		// memory management
 
 		map_pointer allocate_map(size_t n) {
-			return map_allocator::allocate(n);
+			return map_allocator::allocate(this->get_alloc(), n);
 		}
 		void deallocate_map(map_pointer map_ptr, size_t n) {
-			map_allocator::deallocate(map_ptr, n);
+			map_allocator::deallocate(this->get_alloc(), map_ptr, n);
 		}
 		void reallocate_map(size_type node_to_add, bool add_at_front) {
 			size_type old_nodes_num = finish.node - start.node + 1;
@@ -199,11 +251,11 @@ namespace selfmadeSTL {
 				// copy [start, finish) to [new_start_node, new_start_node + old_nodes_num)
 				if (new_start_node < start.node) {
 					// move forward
-					copy(start.node, finish.node + 1, new_start_node);
+					selfmadeSTL::copy(start.node, finish.node + 1, new_start_node);
 				}
 				else {
 					// move backward
-					copy_backward(start.node, finish.node + 1, new_start_node + old_nodes_num);
+					selfmadeSTL::copy_backward(start.node, finish.node + 1, new_start_node + old_nodes_num);
 				}
 			}
 			else {
@@ -211,11 +263,14 @@ namespace selfmadeSTL {
 				map_pointer new_map = allocate_map(new_map_size);
 				// reserve place for new start node
 				new_start_node = new_map + (new_map_size - new_nodes_num) / 2 + (add_at_front ? node_to_add : 0);
-				copy(start.node, finish.node + 1, new_start_node);
+				selfmadeSTL::copy(start.node, finish.node + 1, new_start_node);
 				deallocate_map(map, map_size);
 				map = new_map;
 				map_size = new_map_size;
 			}
+			// iterators point to the new nodes
+			start.set_node(new_start_node);
+			finish.set_node(new_start_node + old_nodes_num - 1);
 		}
 		void initialize_map(size_type elements_num) {
 			size_type nodes_num = elements_num / deque_buffer_size(BufSize, sizeof(T)) + 1;
@@ -254,10 +309,10 @@ namespace selfmadeSTL {
 		}
 
 		T* allocate_node() {
-			return node_allocator::allocate(deque_buffer_size(BufSize, sizeof(T)));
+			return node_allocator::allocate(this->get_alloc(), deque_buffer_size(BufSize, sizeof(T)));
 		}
 		void deallocate_node(T* node) {
-			node_allocator::deallocate(node, deque_buffer_size(BufSize, sizeof(T)));
+			node_allocator::deallocate(this->get_alloc(), node, deque_buffer_size(BufSize, sizeof(T)));
 		}
 		void create_nodes(map_pointer start_node, map_pointer finish_node) {
 			map_pointer curr_node = start_node;
@@ -287,7 +342,7 @@ namespace selfmadeSTL {
 				uninitialized_fill(this->finish.first, this->finish.curr, value);
 			}
 			catch(const std::exception&) {
-				destroy(this->start, iterator(*curr_node, curr_node));
+				destory(this->start, iterator(*curr_node, curr_node));
 			}
 		}
 
@@ -336,57 +391,37 @@ namespace selfmadeSTL {
 			return this->finish + difference_type(n);
 		}
 
-		void push_back_aux(const value_type& value) {
-			value_type value_copy = value;
+		// the last slot of the finish buffer is used, the finish moves to a new buffer
+		template <typename... Args>
+		void emplace_back_aux(Args&&... args) {
 			reserve_map_at_back();
 			*(this->finish.node + 1) = allocate_node();
 			try {
-				construct(this->finish.curr, value_copy);
-				this->finish.set_node(this->finish.node + 1);
-				this->finish.curr = this->finish.first;
+				// args may refer to an element, elements stay where they are
+				construct(this->finish.curr, std::forward<Args>(args)...);
 			}
 			catch (const std::exception&) {
 				deallocate_node(*(this->finish.node + 1));
+				throw;
 			}
+			this->finish.set_node(this->finish.node + 1);
+			this->finish.curr = this->finish.first;
 		}
-		void push_back_aux() {
-			reserve_map_at_back();
-			*(this->finish.node + 1) = allocate_node();
-			try {
-				construct(this->finish.curr);
-				this->finish.set_node(this->finish.node + 1);
-				this->finish.curr = this->finish.first;
-			}
-			catch (const std::exception) {
-				deallocate_node(*(this->finish.node + 1));
-			}
-		}
-		void push_front_aux(const value_type& value) {
-			value_type value_copy = value;
-			reserve_map_at_front();
-			*(this->start.node - 1) = allocate_node();
-			try {
-				this->start.set_node(this->start.node - 1);
-				this->start.curr = this->start.last - 1;
-				construct(this->start.curr, value_copy);
-			}
-			catch(const std::exception&) {
-				++this->start;
-				deallocate_node(*(this->start.node - 1));
-			}
-		}
-		void push_front_aux() {
+		// the start buffer is full at front, the start moves to the last slot of a new buffer
+		template <typename... Args>
+		void emplace_front_aux(Args&&... args) {
 			reserve_map_at_front();
 			*(this->start.node - 1) = allocate_node();
 			try {
-				this->start.set_node(this->start.node - 1);
-				this->start.curr = this->start.last - 1;
-				construct(this->start.curr);
+				construct(*(this->start.node - 1) + deque_buffer_size(BufSize, sizeof(T)) - 1,
+					std::forward<Args>(args)...);
 			}
-			catch(const std::exception) {
-				++this->start;
+			catch (const std::exception&) {
 				deallocate_node(*(this->start.node - 1));
+				throw;
 			}
+			this->start.set_node(this->start.node - 1);
+			this->start.curr = this->start.last - 1;
 		}
 		void pop_back_aux() {
 			deallocate_node(this->finish.first);
@@ -401,24 +436,26 @@ namespace selfmadeSTL {
 			this->start.curr = this->start.first;
 		}
 		
-		iterator insert_aux(iterator pos, const value_type& value) {
+		template <typename... Args>
+		iterator emplace_aux(iterator pos, Args&&... args) {
 			const difference_type element_before = pos - start;
-			value_type value_copy = value;
+			// args may refer to an element that is moved
+			value_type value_copy(std::forward<Args>(args)...);
 			if (element_before < (difference_type)(size() / 2)) {
-				push_front(front());
+				emplace_front(std::move(front()));
 				// map may be extended and changed memory position
 				// here we need to insert after `pos`
 				pos = start + element_before;
-				// copy [start + 2, pos + 1) to [start + 1, pos)
-				copy(start + 2, pos + 1, start + 1);
+				// move [start + 2, pos + 1) to [start + 1, pos)
+				selfmadeSTL::move(start + 2, pos + 1, start + 1);
 			}
 			else {
-				push_back(back());
+				emplace_back(std::move(back()));
 				pos = start + element_before;
-				// copy [pos, finish - 2) to [pos + 1, finish - 1)
-				copy_backward(pos, finish - 2, finish - 1);
+				// move [pos, finish - 2) to [pos + 1, finish - 1)
+				selfmadeSTL::move_backward(pos, finish - 2, finish - 1);
 			}
-			*pos = value_copy;
+			*pos = std::move(value_copy);
 			return pos;
 		}
 		void insert_aux(iterator pos, size_type n, const value_type& value) {
@@ -540,7 +577,7 @@ namespace selfmadeSTL {
 				try {
 					if (element_before < difference_type(n)) {
 						iterator pos_n = pos - difference_type(n);
-						const value_type* mid = first + (difference_type(n) - element_before);
+						const_iterator mid = first + (difference_type(n) - element_before);
 						uninitialized_copy(old_start, pos, new_start);
 						uninitialized_copy(first, mid, pos_n);
 						copy(mid, last, old_start);
@@ -564,7 +601,7 @@ namespace selfmadeSTL {
 				try {
 					if (element_after <= difference_type(n)) {
 						iterator pos_n = pos + difference_type(n);
-						const value_type* mid = first + element_after;
+						const_iterator mid = first + element_after;
 						uninitialized_copy(pos, old_finish, pos_n);
 						uninitialized_copy(mid, last, old_finish);
 						copy(first, mid, pos);
@@ -587,25 +624,40 @@ namespace selfmadeSTL {
 		explicit deque() {
 			initialize_map(0);
 		}
-		explicit deque(size_t n, const value_type& value = value_type()) {
+		explicit deque(const allocator_type& a) : alloc_holder(a) {
+			initialize_map(0);
+		}
+		explicit deque(size_t n, const value_type& value = value_type(), const allocator_type& a = allocator_type())
+			: alloc_holder(a) {
 			initialize_map(n);
 			fill_initialize(value);
 		}
-		deque(const deque& other) {
+		deque(const deque& other) : alloc_holder(other.get_alloc()) {
 			initialize_map(other.size());
 			selfmadeSTL::uninitialized_copy(
 				other.begin(), other.end(), this->start
 			);
 		}
-		deque(const value_type* first, const value_type* last) {
+		deque(const value_type* first, const value_type* last, const allocator_type& a = allocator_type())
+			: alloc_holder(a) {
 			initialize_map(last - first);
 			uninitialized_copy(first, last, this->start);
 		}
-		deque(const_iterator first, const_iterator last) {
+		deque(const_iterator first, const_iterator last, const allocator_type& a = allocator_type())
+			: alloc_holder(a) {
 			initialize_map(last - first);
 			uninitialized_copy(first, last, this->start);
 		}
 		deque& operator=(const deque& other) {
+			invalidate_iterators();
+			if (this != &other && this->copy_assign_changes_alloc(other)) {
+				// give back all the space and start again with the allocator of other
+				clear();
+				deallocate_node(this->start.first);
+				deallocate_map(map, map_size);
+				this->copy_assign_alloc(other);
+				initialize_map(0);
+			}
 			const size_type len = this->size();
 			if (this != &other) {
 				if (len >= other.size()) {
@@ -622,69 +674,84 @@ namespace selfmadeSTL {
 		}
 		~deque() {
 			clear();
+			// clear() keeps the buffer of start
+			deallocate_node(this->start.first);
 			deallocate_map(map, map_size);
 		}
 
-		iterator begin() { return this->start; }
-		iterator end() { return this->finish; }
-		const_iterator begin() const { return this->start; }
-		const_iterator end() const { return this->finish; }
-		const_iterator cbegin() const { return this->start; }
-		const_iterator cend() const { return this->finish; }
+		iterator begin() { return attach(this->start); }
+		iterator end() { return attach(this->finish); }
+		const_iterator begin() const { return attach(const_iterator(this->start)); }
+		const_iterator end() const { return attach(const_iterator(this->finish)); }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend() const { return end(); }
+
+		allocator_type get_allocator() const { return this->get_alloc(); }
 
-		reference front() { return *this->start; }
-		reference back() { return *(this->finish - 1); }
-		const_reference front() const { return *this->start; }
-		const_reference back() const { return *(this->finish - 1); }
+		reference front() {
+			__STL_CHECK(!empty(), "front() of an empty deque");
+			return *this->start;
+		}
+		reference back() {
+			__STL_CHECK(!empty(), "back() of an empty deque");
+			return *(this->finish - 1);
+		}
+		const_reference front() const {
+			__STL_CHECK(!empty(), "front() of an empty deque");
+			return *this->start;
+		}
+		const_reference back() const {
+			__STL_CHECK(!empty(), "back() of an empty deque");
+			return *(this->finish - 1);
+		}
 		reference operator[](size_t idx) {
+			__STL_CHECK(idx < size(), "deque index out of range");
 			return this->start[difference_type(idx)];
 		}
 		const_reference operator[](size_t idx) const {
+			__STL_CHECK(idx < size(), "deque index out of range");
 			return this->start[difference_type(idx)];
 		}
 	
 		size_type size() const { return this->finish - this->start; }
 		bool empty() const { return this->start == this->finish; }
 
-		void push_back(const value_type& value) {
+		// build the value in place at the end
+		template <typename... Args>
+		void emplace_back(Args&&... args) {
+			invalidate_iterators();
 			// if not at the last position of current buffer
 			if (this->finish.curr != this->finish.last - 1) {
-				construct(this->finish.curr, value);
-				++this->finish.curr;
-			}
-			else {
-				push_back_aux(value);
-			}
-		}
-		void push_back() {
-			if (this->finish.curr != this->finish.last - 1) {
-				construct(this->finish.curr);
+				construct(this->finish.curr, std::forward<Args>(args)...);
 				++this->finish.curr;
 			}
 			else {
-				push_back_aux();
+				emplace_back_aux(std::forward<Args>(args)...);
 			}
 		}
-		void push_front(const value_type& value) {
+		// build the value in place at the front
+		template <typename... Args>
+		void emplace_front(Args&&... args) {
+			invalidate_iterators();
 			// if not at the first position of current buffer
 			if (this->start.curr != this->start.first) {
-				construct(this->start.curr - 1, value);
+				construct(this->start.curr - 1, std::forward<Args>(args)...);
 				--this->start.curr;
 			}
 			else {
-				push_front_aux(value);
-			}
-		}
-		void push_front() {
-			if (this->start.curr != this->start.first) {
-				construct(this->start.curr - 1);
-				--this->start.curr;
-			}
-			else {
-				push_front_aux();
+				emplace_front_aux(std::forward<Args>(args)...);
 			}
 		}
+
+		void push_back(const value_type& value) { emplace_back(value); }
+		void push_back(value_type&& value) { emplace_back(std::move(value)); }
+		void push_back() { emplace_back(); }
+		void push_front(const value_type& value) { emplace_front(value); }
+		void push_front(value_type&& value) { emplace_front(std::move(value)); }
+		void push_front() { emplace_front(); }
+		// only the iterators to the popped element are invalidated, they are not checked
 		void pop_back() {
+			__STL_CHECK(!empty(), "pop_back() of an empty deque");
 			if (this->finish.curr != this->finish.first) {
 				--this->finish.curr;
 				destory(this->finish.curr);
@@ -694,6 +761,7 @@ namespace selfmadeSTL {
 			}
 		}
 		void pop_front() {
+			__STL_CHECK(!empty(), "pop_front() of an empty deque");
 			if (this->start.curr != this->start.last - 1) {
 				destory(this->start.curr);
 				++this->start.curr;
@@ -703,21 +771,34 @@ namespace selfmadeSTL {
 			}
 		}
 
-		// insert at the front of the `pos`
-		iterator insert(iterator pos, const value_type& value = value_type()) {
+		// build the value in place at the front of the `pos`
+		template <typename... Args>
+		iterator emplace(iterator position, Args&&... args) {
+			iterator pos = detach(position);
 			if (pos.curr == this->start.curr) {
-				push_front(value);
-				return this->start;
+				emplace_front(std::forward<Args>(args)...);
+				return attach(this->start);
 			}
 			else if (pos.curr == this->finish.curr) {
-				push_back(value);
-				return this->finish - 1;
+				emplace_back(std::forward<Args>(args)...);
+				return attach(this->finish - 1);
 			}
 			else {
-				return insert_aux(pos, value);
+				invalidate_iterators();
+				return attach(emplace_aux(pos, std::forward<Args>(args)...));
 			}
 		}
-		void insert(iterator pos, size_type n, const value_type& value = value_type()) {
+
+		// insert at the front of the `pos`
+		iterator insert(iterator pos, const value_type& value = value_type()) {
+			return emplace(pos, value);
+		}
+		iterator insert(iterator pos, value_type&& value) {
+			return emplace(pos, std::move(value));
+		}
+		void insert(iterator position, size_type n, const value_type& value = value_type()) {
+			iterator pos = detach(position);
+			invalidate_iterators();
 			if (pos.curr == this->start.curr) {
 				iterator new_start = reserve_element_at_front(n);
 				uninitialized_fill(new_start, this->start, value);
@@ -732,7 +813,9 @@ namespace selfmadeSTL {
 				insert_aux(pos, n, value);
 			}
 		}
-		void insert(iterator pos, const value_type* first, const value_type* last) {
+		void insert(iterator position, const value_type* first, const value_type* last) {
+			iterator pos = detach(position);
+			invalidate_iterators();
 			size_type n = last - first;
 			if (pos.curr == this->start.curr) {
 				iterator new_start = reserve_element_at_front(n);
@@ -758,7 +841,9 @@ namespace selfmadeSTL {
 				insert_aux(pos, first, last, n);
 			}
 		}
-		void insert(iterator pos, const_iterator first, const_iterator last) {
+		void insert(iterator position, const_iterator first, const_iterator last) {
+			iterator pos = detach(position);
+			invalidate_iterators();
 			size_type n = last - first;
 			if (pos.curr == this->start.curr) {
 				iterator new_start = reserve_element_at_front(n);
@@ -785,7 +870,10 @@ namespace selfmadeSTL {
 			}
 		}
 
-		iterator erase(iterator pos) {
+		iterator erase(iterator position) {
+			iterator pos = detach(position);
+			__STL_CHECK(pos.curr != this->finish.curr, "erase() of end()");
+			invalidate_iterators();
 			iterator next = pos;
 			++next;
 			difference_type dist = pos - this->start;
@@ -797,13 +885,16 @@ namespace selfmadeSTL {
 				copy(next, this->finish, pos);
 				pop_back();
 			}
-			return this->start + dist;
+			return attach(this->start + dist);
 		}
-		iterator erase(iterator first, iterator last) {
+		iterator erase(iterator first_position, iterator last_position) {
+			iterator first = detach(first_position);
+			iterator last = detach(last_position);
 			if (first == this->start && last == this->finish) {
 				clear();
-				return this->finish;
+				return attach(this->finish);
 			}
+			invalidate_iterators();
 
 			difference_type n = last - first;
 			difference_type element_before = first - this->start;
@@ -823,7 +914,7 @@ namespace selfmadeSTL {
 				destroy_nodes(new_finish.node + 1, this->finish.node + 1);
 				this->finish = new_finish;
 			}
-			return this->start + element_before;
+			return attach(this->start + element_before);
 		}
 
 		void resize(size_type new_size, const value_type& value = value_type()) {
@@ -837,6 +928,7 @@ namespace selfmadeSTL {
 		}
 
 		void clear() {
+			invalidate_iterators();
 			for (map_pointer curr_node = this->start.node + 1; curr_node < this->finish.node; ++curr_node) {
 				destory(*curr_node, *curr_node + deque_buffer_size(BufSize, sizeof(T)));
 				deallocate_node(*curr_node);
@@ -855,10 +947,13 @@ namespace selfmadeSTL {
 		}
 
 		void swap(deque& other) {
+			invalidate_iterators();
+			other.invalidate_iterators();
 			std::swap(this->start, other.start);
 			std::swap(this->finish, other.finish);
 			std::swap(this->map, other.map);
 			std::swap(this->map_size, other.map_size);
+			this->swap_alloc(other);
 		}
 
 		bool operator==(const deque& other) const {
@@ -873,6 +968,12 @@ namespace selfmadeSTL {
 
 	};
 
+	// the iterators point into the map and the buffers, not into the deque
+	template <typename T, typename Alloc, size_t BufSize>
+	struct is_trivially_relocatable<deque<T, Alloc, BufSize>> {
+		typedef typename __alloc_traits<Alloc>::is_trivially_relocatable type;
+	};
+
 }
 
 #endif // !_DEQUE_H_
\ No newline at end of file
@@ -224,6 +224,8 @@ namespace selfmadeSTL{
     protected:
         Operator op;
         typename Operator::first_argument_type x;
+        // reads x to count with a SIMD comparison
+        template <typename Predicate> friend struct __simd_predicate;
     public:
         // when construct this functor, we have get the first argument
         binder1st(const Operator& op, const typename Operator::first_argument_type& value) : op(op), x(value) {}
@@ -245,6 +247,7 @@ namespace selfmadeSTL{
     protected:
         Operator op;
         typename Operator::second_argument_type y;
+        template <typename Predicate> friend struct __simd_predicate;
     public:
         binder2nd(const Operator& op, const typename Operator::second_argument_type& value) : op(op), y(value) {}
         typename Operator::return_type operator()(const typename Operator::first_argument_type& x) const {
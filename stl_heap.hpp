@@ -150,7 +150,7 @@ template <typename RandomAccessIterator, typename Distance, typename T, typename
 
     template <typename RandomAccessIterator>
     inline void make_heap(RandomAccessIterator first, RandomAccessIterator last) {
-        __make_heap(first, last, value_type(first), difference_type(first));
+        __make_heap(first, last, difference_type(first), value_type(first));
     }
     
     template <typename RandomAccessIterator, typename Distance, typename T, typename Compare>
@@ -110,19 +110,19 @@ namespace selfmadeSTL {
 	// determine iterator category
 	template <typename I>
 	inline typename iterator_traits<I>::iterator_category iterator_category(const I& it) {
-		return __iterator_category(it);
+		return selfmadeSTL::__iterator_category(it);
 	}
 
 	// determine iterator distance type
 	template <typename I>
 	inline typename iterator_traits<I>::difference_type* difference_type(const I& it) {
-		return __difference_type(it);
+		return selfmadeSTL::__difference_type(it);
 	}
 
 	// determine iterator distance type
 	template <typename I>
 	inline typename iterator_traits<I>::value_type* value_type(const I& it) {
-		return __value_type(it);
+		return selfmadeSTL::__value_type(it);
 	}
 	// end template partialization
 
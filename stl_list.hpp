@@ -3,6 +3,7 @@
 
 #include "stl_algorithm.hpp"
 #include "stl_allocator.hpp"
+#include "stl_debug.hpp"
 #include "stl_iterator.hpp"
 #include "stl_type_traits.hpp"
 #include "stl_uninitialized.hpp"
@@ -63,8 +64,31 @@ namespace selfmadeSTL {
 		}
 	};
 
+	// the counters of list::sort(), upper limit 2 ^ 64, a counter is built when
+	// it is reached, the ones built are destroyed with their nodes even if sort throws
+	template <typename List>
+	struct __list_sort_counters {
+		alignas(List) unsigned char buffer[64 * sizeof(List)];
+		int fill;
+
+		__list_sort_counters() : fill(0) {}
+		~__list_sort_counters() {
+			for (int i = 0; i < fill; ++i) {
+				(*this)[i].~List();
+			}
+		}
+
+		List& operator[](int i) { return reinterpret_cast<List*>(buffer)[i]; }
+
+		void build(const typename List::allocator_type& a) {
+			new (buffer + fill * sizeof(List)) List(a);
+			++fill;
+		}
+	};
+
+	// Alloc may be a static allocator or an allocator instance kept by the list
 	template <typename T, typename Alloc = alloc>
-	class list {
+	class list : protected __alloc_holder<Alloc> {
 	public:
 		typedef T               value_type;
 		typedef T*              pointer;
@@ -76,20 +100,31 @@ namespace selfmadeSTL {
 		typedef list_node<T>    node;
 
 		typedef simple_alloc<node, Alloc> list_allocator;
+		typedef Alloc           allocator_type;
 
 		typedef list_iterator<T, T&, T*>             iterator;
 		typedef list_iterator<T, const T&, const T*> const_iterator;
 
 	protected:
+		typedef __alloc_holder<Alloc> alloc_holder;
+
 		node* sentinel;
 
 	// auxilary function
 	private:
-		node* get_node() { return list_allocator::allocate((size_type)1); }
-		void put_node(node* n) { list_allocator::deallocate(n); }
-		node* new_node(const T& value) {
+		node* get_node() { return list_allocator::allocate(this->get_alloc()); }
+		void put_node(node* n) { list_allocator::deallocate(this->get_alloc(), n); }
+		// the value is built in the node from args
+		template <typename... Args>
+		node* new_node(Args&&... args) {
 			node* n = get_node();
-			construct(&(n->data), value);
+			try {
+				construct(&(n->data), std::forward<Args>(args)...);
+			}
+			catch (const std::exception&) {
+				put_node(n);
+				throw;
+			}
 			return n;
 		}
 		void delete_node(node* n) {
@@ -105,24 +140,35 @@ namespace selfmadeSTL {
 
 	public:
 		list() { init(); }
-		list(size_type n, const T& value = value_type()) {
+		explicit list(const allocator_type& a) : alloc_holder(a) { init(); }
+		list(size_type n, const T& value = value_type(), const allocator_type& a = allocator_type())
+			: alloc_holder(a) {
 			init();
 			insert(begin(), n, value);
 		}
-		list(const T* first, const T* last) {
+		list(const T* first, const T* last, const allocator_type& a = allocator_type())
+			: alloc_holder(a) {
 			init();
 			insert(begin(), first, last);
 		}
-		list(const_iterator first, const_iterator last) {
+		list(const_iterator first, const_iterator last, const allocator_type& a = allocator_type())
+			: alloc_holder(a) {
 			init();
 			insert(begin(), first, last);
 		}
-		list(const list& other) {
+		list(const list& other) : alloc_holder(other.get_alloc()) {
 			init();
 			insert(begin(), other.begin(), other.end());
 		}
 		list& operator=(const list& other) {
 			if (this != &other) {
+				// the nodes can not be reused if the allocator of other is taken
+				if (this->copy_assign_changes_alloc(other)) {
+					clear();
+					put_node(sentinel);
+					this->copy_assign_alloc(other);
+					init();
+				}
 				iterator first1 = begin();
 				iterator last1 = end();
 				const_iterator first2 = other.begin();
@@ -151,13 +197,27 @@ namespace selfmadeSTL {
 		const_iterator cbegin() const { return sentinel->next; }
 		const_iterator cend() const { return sentinel; }
 
+		allocator_type get_allocator() const { return this->get_alloc(); }
+
 		size_type size() const { return distance(begin(), end()); }
 		bool empty() { return sentinel->next == sentinel; }
 
-		reference front() { return *begin(); }
-		reference back() { return *(--end()); }
-		const_reference front() const { return *begin(); }
-		const_reference back() const { return *(--end()); }
+		reference front() {
+			__STL_CHECK(sentinel->next != sentinel, "front() of an empty list");
+			return *begin();
+		}
+		reference back() {
+			__STL_CHECK(sentinel->next != sentinel, "back() of an empty list");
+			return *(--end());
+		}
+		const_reference front() const {
+			__STL_CHECK(sentinel->next != sentinel, "front() of an empty list");
+			return *begin();
+		}
+		const_reference back() const {
+			__STL_CHECK(sentinel->next != sentinel, "back() of an empty list");
+			return *(--end());
+		}
 		
 		bool operator==(const list& other) {
 			node* s1 = this->sentinel;
@@ -179,14 +239,27 @@ namespace selfmadeSTL {
 			return selfmadeSTL::lexicographical_compare(begin(), end(), other.begin(), other.end());
 		}
 
-		iterator insert(iterator pos, const T& value = value_type()) {
-			node* temp = new_node(value);
+		// build the value in place in front of pos
+		template <typename... Args>
+		iterator emplace(iterator pos, Args&&... args) {
+			node* temp = new_node(std::forward<Args>(args)...);
 			temp->next = pos.inner;
 			temp->prev = pos.inner->prev;
 			pos.inner->prev->next = temp;
 			pos.inner->prev = temp;
 			return iterator(temp);
 		}
+		template <typename... Args>
+		void emplace_front(Args&&... args) { emplace(begin(), std::forward<Args>(args)...); }
+		template <typename... Args>
+		void emplace_back(Args&&... args) { emplace(end(), std::forward<Args>(args)...); }
+
+		iterator insert(iterator pos, const T& value = value_type()) {
+			return emplace(pos, value);
+		}
+		iterator insert(iterator pos, T&& value) {
+			return emplace(pos, std::move(value));
+		}
 		void insert(iterator pos, const T* first, const T* last) {
 			for (; first != last; ++first) {
 				insert(pos, *first);
@@ -205,8 +278,11 @@ namespace selfmadeSTL {
 
 		void push_front(const T& value = value_type()) { insert(begin(), value); }
 		void push_back(const T& value = value_type()) { insert(end(), value); }
+		void push_front(T&& value) { insert(begin(), std::move(value)); }
+		void push_back(T&& value) { insert(end(), std::move(value)); }
 
 		iterator erase(iterator pos) {
+			__STL_CHECK(pos.inner != sentinel, "erase() of end()");
 			auto next_node = pos.inner->next;
 			pos.inner->prev->next = pos.inner->next;
 			pos.inner->next->prev = pos.inner->prev;
@@ -219,8 +295,12 @@ namespace selfmadeSTL {
 			}
 		}
 
-		void pop_front() { erase(begin()); }
+		void pop_front() {
+			__STL_CHECK(sentinel->next != sentinel, "pop_front() of an empty list");
+			erase(begin());
+		}
 		void pop_back() {
+			__STL_CHECK(sentinel->next != sentinel, "pop_back() of an empty list");
 			auto temp = end();
 			erase(--temp);
 		}
@@ -252,6 +332,7 @@ namespace selfmadeSTL {
 	
 		void swap(list& other) {
 			std::swap(sentinel, other.sentinel);
+			this->swap_alloc(other);
 		}
 
 		void remove(const T& value) {
@@ -389,29 +470,28 @@ namespace selfmadeSTL {
 		void sort() {
 			// do nothing if size() is 0 or 1
 			if (sentinel->next != sentinel && sentinel->next->next != sentinel) {
-				list carry;
-				// upper limit 2 ^ 64
-				list counter[64];
+				list carry(this->get_alloc());
+				// all of the counters share the allocator of this list
+				__list_sort_counters<list> counter;
 
-				int fill = 0;
 				while (!empty()) {
 					// put the begin() element to carry
 					carry.splice(carry.begin(), *this, begin());
 					int i = 0;
-					while (i < fill && !counter[i].empty()) {
+					while (i < counter.fill && !counter[i].empty()) {
 						// here we sort it
 						counter[i].merge(carry);
 						carry.swap(counter[i++]);
 					}
-					carry.swap(counter[i]);
-					if (i == fill) {
-						++fill;
+					if (i == counter.fill) {
+						counter.build(this->get_alloc());
 					}
+					carry.swap(counter[i]);
 				}
-				for (int i = 1; i < fill; ++i) {
+				for (int i = 1; i < counter.fill; ++i) {
 					counter[i].merge(counter[i - 1]);
 				}
-				swap(counter[fill - 1]);
+				swap(counter[counter.fill - 1]);
 			}
 		}
 
@@ -419,33 +499,38 @@ namespace selfmadeSTL {
 		void sort(Compare comp) {
 			// do nothing if size() is 0 or 1
 			if (sentinel->next != sentinel && sentinel->next->next != sentinel) {
-				list carry;
-				// 2 ^ 64 size list
-				list counter[64];
+				list carry(this->get_alloc());
+				// all of the counters share the allocator of this list
+				__list_sort_counters<list> counter;
 
-				int fill = 0;
 				while (!empty()) {
 					// put the begin() element to carry
 					carry.splice(carry.begin(), *this, begin());
 					int i = 0;
-					while (i < fill && !counter[i].empty()) {
+					while (i < counter.fill && !counter[i].empty()) {
 						// here we sort it
 						counter[i].merge(carry, comp);
 						carry.swap(counter[i++]);
 					}
-					carry.swap(counter[i]);
-					if (i == fill) {
-						++fill;
+					if (i == counter.fill) {
+						counter.build(this->get_alloc());
 					}
+					carry.swap(counter[i]);
 				}
-				for (int i = 1; i < fill; ++i) {
-					counter[i].merge(counter[i - 1]);
+				for (int i = 1; i < counter.fill; ++i) {
+					counter[i].merge(counter[i - 1], comp);
 				}
-				swap(counter[fill - 1]);
+				swap(counter[counter.fill - 1]);
 			}
 		}
 
 	};
+
+	// the sentinel node is on the heap, no node points back to the list
+	template <typename T, typename Alloc>
+	struct is_trivially_relocatable<list<T, Alloc>> {
+		typedef typename __alloc_traits<Alloc>::is_trivially_relocatable type;
+	};
 }
 
 #endif // !_LIST_H_
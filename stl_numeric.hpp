@@ -2,11 +2,23 @@
 #define _NUMERIC_H_
 
 #include "stl_function.hpp"
+#include "stl_iterator.hpp"
+#include "stl_simd.hpp"
+#include "stl_type_traits.hpp"
 
 namespace selfmadeSTL {
 
+	// accumulate, inner_product and partial_sum of integers are vectorized as they are,
+	// the sum of floating point values rounds differently when it is added up in
+	// another order, so they are vectorized only when this tag is passed first
+	struct unsequenced_policy {};
+
+	const unsequenced_policy unseq = unsequenced_policy();
+
+	//! accumulate !//
+	//! O(n)
 	template <typename InputIterator, typename T>
-	T accumulate(InputIterator first, InputIterator last, T init) {
+	T __accumulate(InputIterator first, InputIterator last, T init, __false_type) {
 		for (; first != last; ++first) {
 			// c++ standard
 			init = init + *first;
@@ -14,14 +26,52 @@ namespace selfmadeSTL {
 		return init;
 	}
 
+	//! O(n)
+	template <typename Pointer, typename T>
+	inline T __accumulate(Pointer first, Pointer last, T init, __true_type) {
+		return __simd_accumulate<simd_add>(first, last, init);
+	}
+
+	//! O(n)
 	template <typename InputIterator, typename T, typename BinaryOperator>
-	T accumulate(InputIterator first, InputIterator last, T init, BinaryOperator op) {
+	T __accumulate(InputIterator first, InputIterator last, T init, BinaryOperator op, __false_type) {
 		for (; first != last; ++first) {
 			init = op(init, *first);
 		}
 		return init;
 	}
 
+	//! O(n)
+	template <typename Pointer, typename T, typename BinaryOperator>
+	inline T __accumulate(Pointer first, Pointer last, T init, BinaryOperator, __true_type) {
+		return __simd_accumulate<__simd_arithmetic_operator<BinaryOperator>::arithmetic>(first, last, init);
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename T>
+	inline T accumulate(InputIterator first, InputIterator last, T init) {
+		return __accumulate(first, last, init, typename __simd_numeric<InputIterator, T, plus<T>, false>::type());
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename T, typename BinaryOperator>
+	inline T accumulate(InputIterator first, InputIterator last, T init, BinaryOperator op) {
+		return __accumulate(first, last, init, op, typename __simd_numeric<InputIterator, T, BinaryOperator, false>::type());
+	}
+
+	// the floating point values may be added up in any order
+	//! O(n)
+	template <typename InputIterator, typename T>
+	inline T accumulate(const unsequenced_policy&, InputIterator first, InputIterator last, T init) {
+		return __accumulate(first, last, init, typename __simd_numeric<InputIterator, T, plus<T>, true>::type());
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename T, typename BinaryOperator>
+	inline T accumulate(const unsequenced_policy&, InputIterator first, InputIterator last, T init, BinaryOperator op) {
+		return __accumulate(first, last, init, op, typename __simd_numeric<InputIterator, T, BinaryOperator, true>::type());
+	}
+
 	template <typename InputIterator, typename OutputIterator>
 	OutputIterator adjacent_difference(InputIterator first, InputIterator last, OutputIterator result) {
 		if (first == last) {
@@ -56,50 +106,127 @@ namespace selfmadeSTL {
 		return ++result;
 	}
 
-	template <typename InputIterator, typename OutputIterator>
-	OutputIterator partial_sum(InputIterator first, InputIterator last, OutputIterator result) {
+	//! partial_sum !//
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator, typename BinaryOperator>
+	OutputIterator __partial_sum(InputIterator first, InputIterator last, OutputIterator result, BinaryOperator op, __false_type) {
 		if (first == last) {
 			return result;
 		}
 		*result = *first;
 		auto sum = *first;
 		while (++first != last) {
-			sum = sum + *first;
+			sum = op(sum, *first);
 			*++result = sum;
 		}
 		return ++result;
 	}
 
+	// the vectors are read before they are written, so result may be first,
+	// but not somewhere else in the range
+	//! O(n)
+	template <typename Pointer, typename T, typename BinaryOperator>
+	inline T* __partial_sum(Pointer first, Pointer last, T* result, BinaryOperator op, __true_type) {
+		if (result != first && result < last && first < result + (last - first)) {
+			return __partial_sum(first, last, result, op, __false_type());
+		}
+		__simd_partial_sum<__simd_arithmetic_operator<BinaryOperator>::arithmetic>(first, last, result);
+		return result + (last - first);
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator>
+	OutputIterator partial_sum(InputIterator first, InputIterator last, OutputIterator result) {
+		typedef typename iterator_traits<InputIterator>::value_type T;
+		return __partial_sum(first, last, result, plus<T>(),
+			typename __simd_scan<InputIterator, OutputIterator, plus<T>, false>::type());
+	}
+
+	//! O(n)
 	template <typename InputIterator, typename OutputIterator, typename BinaryOperator>
 	OutputIterator partial_sum(InputIterator first, InputIterator last, OutputIterator result, BinaryOperator op) {
-		if (first == last) {
-			return result;
-		}
-		*result = *first;
-		auto sum = *first;
-		while (++first != last) {
-			sum = op(sum, *first);
-			*++result = sum;
-		}
-		return ++result;
+		return __partial_sum(first, last, result, op,
+			typename __simd_scan<InputIterator, OutputIterator, BinaryOperator, false>::type());
 	}
 
+	// the floating point sums may be added up in any order
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator>
+	OutputIterator partial_sum(const unsequenced_policy&, InputIterator first, InputIterator last, OutputIterator result) {
+		typedef typename iterator_traits<InputIterator>::value_type T;
+		return __partial_sum(first, last, result, plus<T>(),
+			typename __simd_scan<InputIterator, OutputIterator, plus<T>, true>::type());
+	}
+
+	//! O(n)
+	template <typename InputIterator, typename OutputIterator, typename BinaryOperator>
+	OutputIterator partial_sum(const unsequenced_policy&, InputIterator first, InputIterator last, OutputIterator result, BinaryOperator op) {
+		return __partial_sum(first, last, result, op,
+			typename __simd_scan<InputIterator, OutputIterator, BinaryOperator, true>::type());
+	}
+
+	//! inner_product !//
+	//! O(n)
 	template <typename InputIterator1, typename InputIterator2, typename T>
-	T inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init) {
+	T __inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init, __false_type) {
 		for ( ; first1 != last1; ++first1, ++first2) {
 			init = init + (*first1 * *first2);
 		}
 		return init;
 	}
 
+	//! O(n)
+	template <typename Pointer1, typename Pointer2, typename T>
+	inline T __inner_product(Pointer1 first1, Pointer1 last1, Pointer2 first2, T init, __true_type) {
+		return __simd_inner_product<T>(first1, last1, first2, init);
+	}
+
+	//! O(n)
 	template <typename InputIterator1, typename InputIterator2, typename T, typename BinaryOperator1, typename BinaryOperator2>
-	T inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init, BinaryOperator1 op1, BinaryOperator2 op2) {
+	T __inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init, BinaryOperator1 op1, BinaryOperator2 op2, __false_type) {
 		for ( ; first1 != last1; ++first1, ++first2) {
 			init = op1(init, op2(*first1, *first2));
 		}
 		return init;
 	}
 
+	// op1 is plus and op2 is multiply
+	//! O(n)
+	template <typename Pointer1, typename Pointer2, typename T, typename BinaryOperator1, typename BinaryOperator2>
+	inline T __inner_product(Pointer1 first1, Pointer1 last1, Pointer2 first2, T init, BinaryOperator1, BinaryOperator2, __true_type) {
+		return __simd_inner_product<T>(first1, last1, first2, init);
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2, typename T>
+	inline T inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init) {
+		return __inner_product(first1, last1, first2, init,
+			typename __simd_dot<InputIterator1, InputIterator2, T, plus<T>, multiply<T>, false>::type());
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2, typename T, typename BinaryOperator1, typename BinaryOperator2>
+	inline T inner_product(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init, BinaryOperator1 op1, BinaryOperator2 op2) {
+		return __inner_product(first1, last1, first2, init, op1, op2,
+			typename __simd_dot<InputIterator1, InputIterator2, T, BinaryOperator1, BinaryOperator2, false>::type());
+	}
+
+	// the floating point products may be added up in any order
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2, typename T>
+	inline T inner_product(const unsequenced_policy&, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init) {
+		return __inner_product(first1, last1, first2, init,
+			typename __simd_dot<InputIterator1, InputIterator2, T, plus<T>, multiply<T>, true>::type());
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2, typename T, typename BinaryOperator1, typename BinaryOperator2>
+	inline T inner_product(const unsequenced_policy&, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init,
+		BinaryOperator1 op1, BinaryOperator2 op2) {
+		return __inner_product(first1, last1, first2, init, op1, op2,
+			typename __simd_dot<InputIterator1, InputIterator2, T, BinaryOperator1, BinaryOperator2, true>::type());
+	}
+
 	template <typename T, typename Integer, typename MonoidOperator>
 	T power(T x, Integer n, MonoidOperator op) {
 		if (n == 0) {
@@ -0,0 +1,481 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "stl_algorithm.hpp"
+#include "stl_deque.hpp"
+#include "stl_function.hpp"
+#include "stl_iterator.hpp"
+#include "stl_vector.hpp"
+
+namespace selfmadeSTL {
+
+	//! execution policy !//
+
+	// run on the calling thread, the same as the algorithm without a policy
+	struct sequenced_policy {};
+
+	// run on threads threads, 0 for one per hardware thread
+	struct parallel_policy {
+		size_t threads;
+
+		explicit parallel_policy(size_t n = 0) : threads(n) {}
+
+		// how many threads there are at last
+		size_t thread_count() const {
+			if (threads != 0)
+				return threads;
+			size_t hardware = std::thread::hardware_concurrency();
+			return hardware != 0 ? hardware : 1;
+		}
+	};
+
+	const sequenced_policy seq = sequenced_policy();
+	const parallel_policy par = parallel_policy();
+
+	//! work-stealing thread pool !//
+
+	// each worker keeps its own queue, it takes its newest task first (the one
+	// still in its cache) and an idle worker steals the oldest task of another,
+	// which is the largest one for a divide and conquer algorithm
+	// the thread that waits in run_until_done() works as worker 0
+	class work_stealing_pool {
+	public:
+		typedef std::function<void()> task;
+
+	private:
+		// the lock guards only one queue, a queue whose map grows allocates on its
+		// worker thread, so the queues take the thread safe allocator
+		struct worker_queue {
+			std::mutex lock;
+			deque<task, thread_alloc> tasks;
+		};
+
+		size_t worker_count;
+		std::unique_ptr<worker_queue[]> queues;
+		vector<std::thread> threads;
+
+		// tasks submitted and not finished yet
+		std::atomic<size_t> pending;
+		std::atomic<bool> stopping;
+		// wakes the sleeping workers when a task comes
+		std::mutex sleep_lock;
+		std::condition_variable wake;
+
+		// the first exception thrown by a task, run_until_done() throws it again
+		std::mutex error_lock;
+		std::exception_ptr error;
+
+		// the worker the current thread is, in the pool it works for
+		struct worker_slot {
+			const work_stealing_pool* pool;
+			size_t index;
+		};
+		static worker_slot& current_worker() {
+			static thread_local worker_slot slot = { nullptr, 0 };
+			return slot;
+		}
+
+		size_t my_index() const {
+			const worker_slot& slot = current_worker();
+			return slot.pool == this ? slot.index : 0;
+		}
+
+		bool pop_own(size_t index, task& t) {
+			worker_queue& q = queues[index];
+			std::lock_guard<std::mutex> guard(q.lock);
+			if (q.tasks.empty())
+				return false;
+			t = std::move(q.tasks.back());
+			q.tasks.pop_back();
+			return true;
+		}
+
+		bool steal(size_t index, task& t) {
+			for (size_t i = 1; i < worker_count; ++i) {
+				worker_queue& q = queues[(index + i) % worker_count];
+				std::lock_guard<std::mutex> guard(q.lock);
+				if (!q.tasks.empty()) {
+					t = std::move(q.tasks.front());
+					q.tasks.pop_front();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// run one task if there is one
+		bool run_one(size_t index) {
+			task t;
+			if (!pop_own(index, t) && !steal(index, t))
+				return false;
+			try {
+				t();
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> guard(error_lock);
+				if (!error)
+					error = std::current_exception();
+			}
+			--pending;
+			return true;
+		}
+
+		void worker_loop(size_t index) {
+			current_worker().pool = this;
+			current_worker().index = index;
+			while (!stopping) {
+				if (!run_one(index)) {
+					std::unique_lock<std::mutex> guard(sleep_lock);
+					wake.wait_for(guard, std::chrono::milliseconds(1));
+				}
+			}
+		}
+
+	public:
+		// thread_count threads take the tasks, the waiting thread is one of them
+		explicit work_stealing_pool(size_t thread_count)
+			: worker_count(thread_count != 0 ? thread_count : 1),
+			  queues(new worker_queue[worker_count]),
+			  pending(0), stopping(false) {
+			threads.reserve(worker_count - 1);
+			for (size_t i = 1; i < worker_count; ++i) {
+				threads.emplace_back(&work_stealing_pool::worker_loop, this, i);
+			}
+		}
+
+		work_stealing_pool(const work_stealing_pool&) = delete;
+		work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+		~work_stealing_pool() {
+			stopping = true;
+			wake.notify_all();
+			for (size_t i = 0; i < threads.size(); ++i) {
+				threads[i].join();
+			}
+		}
+
+		size_t size() const { return worker_count; }
+
+		// a task submitted by a task goes to the queue of its worker
+		void submit(task t) {
+			++pending;
+			worker_queue& q = queues[my_index()];
+			{
+				std::lock_guard<std::mutex> guard(q.lock);
+				q.tasks.push_back(std::move(t));
+			}
+			wake.notify_one();
+		}
+
+		// work until every submitted task is finished
+		void run_until_done() {
+			size_t index = my_index();
+			while (pending != 0) {
+				if (!run_one(index)) {
+					std::this_thread::yield();
+				}
+			}
+			if (error) {
+				std::exception_ptr e = error;
+				error = nullptr;
+				std::rethrow_exception(e);
+			}
+		}
+	};
+
+	//! parallel sort !//
+
+	// below this size a range is sorted on one thread
+	const ptrdiff_t parallel_sort_threshold = 1 << 15;
+
+	// the same loop as __introsort_loop, but the right part of each partition
+	// is a task of its own, a range of at most grain elements is a leaf that is
+	// sorted by the sequential __introsort_loop
+	// depth_limit is passed down, so a range still turns into heap sort
+	// after log(n) bad partitions
+	//! O(nlogn)
+	template <typename RandomAccessIterator, typename T, typename Size, typename Compare>
+	void __parallel_introsort_loop(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+		T*, Size depth_limit, Compare comp, ptrdiff_t grain, bool leftmost) {
+		while (last - first > grain) {
+			ptrdiff_t len = last - first;
+			__choose_pivot(first, last, comp);
+			if (!leftmost && !comp(*(first - 1), *first)) {
+				first = __partition_left(first, last, comp) + 1;
+				continue;
+			}
+			pair<RandomAccessIterator, bool> cut = __partition_right(first, last, comp);
+			RandomAccessIterator pivot = cut.first;
+			if (pivot - first < len / 8 || last - (pivot + 1) < len / 8) {
+				if (depth_limit == 0) {
+					selfmadeSTL::partial_sort(first, last, last, comp);
+					return;
+				}
+				--depth_limit;
+				__break_patterns(first, pivot, last);
+			}
+			else if (cut.second && __partial_insertion_sort(first, pivot, comp)
+				&& __partial_insertion_sort(pivot + 1, last, comp)) {
+				return;
+			}
+			pool.submit([&pool, pivot, last, depth_limit, comp, grain]() {
+				__parallel_introsort_loop(pool, pivot + 1, last, (T*)0, depth_limit, comp, grain, false);
+			});
+			last = pivot;
+		}
+		__introsort_loop(first, last, (T*)0, depth_limit, comp, leftmost);
+	}
+
+	template <typename RandomAccessIterator, typename T, typename Compare>
+	void __parallel_sort(RandomAccessIterator first, RandomAccessIterator last, T*, Compare comp, size_t threads) {
+		ptrdiff_t len = last - first;
+		if (threads <= 1 || len <= parallel_sort_threshold) {
+			selfmadeSTL::sort(first, last, comp);
+			return;
+		}
+		// several leaves per thread, so that a thread with a bad split can be helped
+		ptrdiff_t grain = max(len / ptrdiff_t(threads * 8), parallel_sort_threshold / 4);
+		work_stealing_pool pool(threads);
+		pool.submit([&pool, first, last, len, comp, grain]() {
+			__parallel_introsort_loop(pool, first, last, (T*)0, __log2(len), comp, grain, true);
+		});
+		pool.run_until_done();
+	}
+
+	//! O(nlogn)
+	template <typename RandomAccessIterator>
+	inline void sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last) {
+		selfmadeSTL::sort(first, last);
+	}
+
+	//! O(nlogn)
+	template <typename RandomAccessIterator, typename Compare>
+	inline void sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		selfmadeSTL::sort(first, last, comp);
+	}
+
+	//! O(nlogn / threads)
+	template <typename RandomAccessIterator>
+	inline void sort(const parallel_policy& policy, RandomAccessIterator first, RandomAccessIterator last) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		__parallel_sort(first, last, (T*)0, less<T>(), policy.thread_count());
+	}
+
+	//! O(nlogn / threads)
+	template <typename RandomAccessIterator, typename Compare>
+	inline void sort(const parallel_policy& policy, RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		__parallel_sort(first, last, (T*)0, comp, policy.thread_count());
+	}
+
+	//! parallel merge !//
+
+	// the leaf of a parallel merge copies the values, or moves them when the
+	// inputs are the runs of a stable sort
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Compare>
+	inline void __merge_leaf(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator1 first2,
+		RandomAccessIterator1 last2, RandomAccessIterator2 result, Compare comp, __false_type) {
+		selfmadeSTL::merge(first1, last1, first2, last2, result, comp);
+	}
+
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Compare>
+	inline void __merge_leaf(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator1 first2,
+		RandomAccessIterator1 last2, RandomAccessIterator2 result, Compare comp, __true_type) {
+		__move_merge(first1, last1, first2, last2, result, comp);
+	}
+
+	// the larger input is cut at its middle and the other one where that value
+	// would go, with lower_bound for a value of the first input and upper_bound
+	// for one of the second, so the equal values of the first input stay in front
+	// the two halves merge into disjoint parts of the output, the right one as
+	// a task of its own, until a merge has at most grain values
+	//! O(n)
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Compare, typename Moving>
+	void __parallel_merge_loop(work_stealing_pool& pool, RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+		RandomAccessIterator1 first2, RandomAccessIterator1 last2, RandomAccessIterator2 result, Compare comp,
+		ptrdiff_t grain, Moving moving) {
+		while ((last1 - first1) + (last2 - first2) > grain) {
+			RandomAccessIterator1 cut1, cut2;
+			if (last1 - first1 >= last2 - first2) {
+				cut1 = first1 + (last1 - first1) / 2;
+				cut2 = lower_bound(first2, last2, *cut1, comp);
+			}
+			else {
+				cut2 = first2 + (last2 - first2) / 2;
+				cut1 = upper_bound(first1, last1, *cut2, comp);
+			}
+			RandomAccessIterator2 cut_result = result + ((cut1 - first1) + (cut2 - first2));
+			pool.submit([&pool, cut1, last1, cut2, last2, cut_result, comp, grain, moving]() {
+				__parallel_merge_loop(pool, cut1, last1, cut2, last2, cut_result, comp, grain, moving);
+			});
+			last1 = cut1;
+			last2 = cut2;
+		}
+		__merge_leaf(first1, last1, first2, last2, result, comp, moving);
+	}
+
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Compare>
+	RandomAccessIterator2 __parallel_merge(RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+		RandomAccessIterator1 first2, RandomAccessIterator1 last2, RandomAccessIterator2 result, Compare comp, size_t threads) {
+		ptrdiff_t len = (last1 - first1) + (last2 - first2);
+		if (threads <= 1 || len <= parallel_sort_threshold) {
+			return selfmadeSTL::merge(first1, last1, first2, last2, result, comp);
+		}
+		ptrdiff_t grain = max(len / ptrdiff_t(threads * 8), parallel_sort_threshold / 4);
+		work_stealing_pool pool(threads);
+		pool.submit([&pool, first1, last1, first2, last2, result, comp, grain]() {
+			__parallel_merge_loop(pool, first1, last1, first2, last2, result, comp, grain, __false_type());
+		});
+		pool.run_until_done();
+		return result + len;
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+	inline OutputIterator merge(const sequenced_policy&, InputIterator1 first1, InputIterator1 last1,
+		InputIterator2 first2, InputIterator2 last2, OutputIterator result) {
+		return selfmadeSTL::merge(first1, last1, first2, last2, result);
+	}
+
+	//! O(n)
+	template <typename InputIterator1, typename InputIterator2, typename OutputIterator, typename Compare>
+	inline OutputIterator merge(const sequenced_policy&, InputIterator1 first1, InputIterator1 last1,
+		InputIterator2 first2, InputIterator2 last2, OutputIterator result, Compare comp) {
+		return selfmadeSTL::merge(first1, last1, first2, last2, result, comp);
+	}
+
+	// the inputs must be the same iterator type, so that one is cut where a value
+	// of the other would go
+	//! O(n / threads)
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2>
+	inline RandomAccessIterator2 merge(const parallel_policy& policy, RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+		RandomAccessIterator1 first2, RandomAccessIterator1 last2, RandomAccessIterator2 result) {
+		typedef typename iterator_traits<RandomAccessIterator1>::value_type T;
+		return __parallel_merge(first1, last1, first2, last2, result, less<T>(), policy.thread_count());
+	}
+
+	//! O(n / threads)
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Compare>
+	inline RandomAccessIterator2 merge(const parallel_policy& policy, RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+		RandomAccessIterator1 first2, RandomAccessIterator1 last2, RandomAccessIterator2 result, Compare comp) {
+		return __parallel_merge(first1, last1, first2, last2, result, comp, policy.thread_count());
+	}
+
+	//! parallel stable sort !//
+
+	// merge each two neighbouring runs of [from, from + bounds.back()) into to,
+	// a run without a partner is moved as it is, bounds become those of the merged runs
+	//! O(n / threads)
+	template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Compare>
+	void __parallel_merge_runs(work_stealing_pool& pool, RandomAccessIterator1 from, RandomAccessIterator2 to,
+		vector<ptrdiff_t>& bounds, Compare comp, ptrdiff_t grain) {
+		vector<ptrdiff_t> merged;
+		merged.push_back(0);
+		for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+			RandomAccessIterator1 first1 = from + bounds[i];
+			RandomAccessIterator1 last1 = from + bounds[i + 1];
+			RandomAccessIterator1 last2 = i + 2 < bounds.size() ? from + bounds[i + 2] : last1;
+			RandomAccessIterator2 result = to + bounds[i];
+			pool.submit([&pool, first1, last1, last2, result, comp, grain]() {
+				__parallel_merge_loop(pool, first1, last1, last1, last2, result, comp, grain, __true_type());
+			});
+			merged.push_back(last2 - from);
+		}
+		pool.run_until_done();
+		bounds.swap(merged);
+	}
+
+	// the range is cut in one run for each thread, each run is sorted through
+	// its own part of one buffer as long as the range, then the runs are merged
+	// in pairs between the range and the buffer, every merge in parallel
+	// without a buffer that long, it is the sequential stable_sort
+	template <typename RandomAccessIterator, typename T, typename Compare>
+	void __parallel_stable_sort(RandomAccessIterator first, RandomAccessIterator last, T*, Compare comp, size_t threads) {
+		ptrdiff_t len = last - first;
+		if (threads <= 1 || len <= parallel_sort_threshold) {
+			selfmadeSTL::stable_sort(first, last, comp);
+			return;
+		}
+		__temporary_buffer<RandomAccessIterator, T> buffer(first, len);
+		if (buffer.size() < len) {
+			selfmadeSTL::stable_sort(first, last, comp);
+			return;
+		}
+		ptrdiff_t runs = min(ptrdiff_t(threads), len / (parallel_sort_threshold / 4));
+		vector<ptrdiff_t> bounds;
+		for (ptrdiff_t i = 0; i <= runs; ++i) {
+			bounds.push_back(len / runs * i + min(i, len % runs));
+		}
+
+		work_stealing_pool pool(threads);
+		T* buf = buffer.begin();
+		for (ptrdiff_t i = 0; i < runs; ++i) {
+			RandomAccessIterator run_first = first + bounds[i];
+			RandomAccessIterator run_last = first + bounds[i + 1];
+			T* run_buffer = buf + bounds[i];
+			pool.submit([run_first, run_last, run_buffer, comp]() {
+				ptrdiff_t run_len = run_last - run_first;
+				__stable_sort_adaptive(run_first, run_last, run_buffer, run_len, comp);
+			});
+		}
+		pool.run_until_done();
+
+		ptrdiff_t grain = max(len / ptrdiff_t(threads * 8), parallel_sort_threshold / 4);
+		bool in_buffer = false;
+		while (bounds.size() > 2) {
+			if (in_buffer) {
+				__parallel_merge_runs(pool, buf, first, bounds, comp, grain);
+			}
+			else {
+				__parallel_merge_runs(pool, first, buf, bounds, comp, grain);
+			}
+			in_buffer = !in_buffer;
+		}
+		if (in_buffer) {
+			for (ptrdiff_t from = 0; from < len; from += grain) {
+				ptrdiff_t to = min(from + grain, len);
+				pool.submit([buf, first, from, to]() {
+					selfmadeSTL::move(buf + from, buf + to, first + from);
+				});
+			}
+			pool.run_until_done();
+		}
+	}
+
+	//! O(nlogn)
+	template <typename RandomAccessIterator>
+	inline void stable_sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last) {
+		selfmadeSTL::stable_sort(first, last);
+	}
+
+	//! O(nlogn)
+	template <typename RandomAccessIterator, typename Compare>
+	inline void stable_sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		selfmadeSTL::stable_sort(first, last, comp);
+	}
+
+	//! O(nlogn / threads)
+	template <typename RandomAccessIterator>
+	inline void stable_sort(const parallel_policy& policy, RandomAccessIterator first, RandomAccessIterator last) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		__parallel_stable_sort(first, last, (T*)0, less<T>(), policy.thread_count());
+	}
+
+	//! O(nlogn / threads)
+	template <typename RandomAccessIterator, typename Compare>
+	inline void stable_sort(const parallel_policy& policy, RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+		__parallel_stable_sort(first, last, (T*)0, comp, policy.thread_count());
+	}
+}
+
+#endif // !_PARALLEL_H_
@@ -0,0 +1,1503 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "stl_function.hpp"
+#include "stl_type_traits.hpp"
+
+// SSE2 and AVX2 kernels for contiguous ranges of arithmetic values, the
+// algorithms take them for raw pointers (and the iterators of vector) and
+// keep the loop one element at a time for every other iterator
+// SSE2 is always there on x86-64, AVX2 is looked for when the program runs
+// __STL_NO_SIMD leaves only the scalar loops
+
+#if !defined(__STL_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define __STL_SIMD
+#endif
+
+#ifdef __STL_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// the AVX2 intrinsics need no target on MSVC
+#define __STL_AVX2_TARGET
+#else
+#define __STL_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace selfmadeSTL {
+
+	enum simd_level { simd_scalar, simd_sse2, simd_avx2 };
+
+	// the widest level the processor has, it can be lowered to compare the
+	// kernels with each other, and never raised above what the processor has
+	template <int inst>
+	class __simd_dispatch_template {
+	private:
+		static int __level_limit;
+
+		static int detect() {
+#ifndef __STL_SIMD
+			return simd_scalar;
+#elif defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return simd_sse2;
+			__cpuid(info, 1);
+			// the system saves the ymm registers
+			const bool avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+			if (!avx || (_xgetbv(0) & 6) != 6)
+				return simd_sse2;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0 ? simd_avx2 : simd_sse2;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") ? simd_avx2 : simd_sse2;
+#endif
+		}
+
+	public:
+		static int hardware_level() {
+			static const int level = detect();
+			return level;
+		}
+
+		static int level() {
+			const int hardware = hardware_level();
+			return __level_limit < hardware ? __level_limit : hardware;
+		}
+
+		// return the old limit
+		static int __set_level(int limit) {
+			int __old = __level_limit;
+			__level_limit = limit;
+			return __old;
+		}
+	};
+
+	template <int inst>
+	int __simd_dispatch_template<inst>::__level_limit = simd_avx2;
+
+	typedef __simd_dispatch_template<0> simd_dispatch;
+
+	// T is a value the kernels take, an arithmetic type of 1, 2, 4 or 8 bytes
+	// other than bool
+	template <typename T>
+	struct __simd_element {
+#ifdef __STL_SIMD
+		typedef typename __bool_type<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+			!std::is_same<T, long double>::value &&
+			(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>::type type;
+#else
+		typedef __false_type type;
+#endif
+	};
+
+	// Iterator is a pointer to a value the kernels take
+	template <typename Iterator>
+	struct __simd_pointer {
+		typedef __false_type type;
+		typedef void element_type;
+	};
+
+	template <typename T>
+	struct __simd_pointer<T*> {
+		typedef typename std::remove_cv<T>::type element_type;
+		typedef typename __simd_element<element_type>::type type;
+	};
+
+	// Iterator is a pointer to integers the kernels take
+	template <typename Iterator>
+	struct __simd_integer_pointer {
+		typedef typename __bool_type<
+			std::is_same<typename __simd_pointer<Iterator>::type, __true_type>::value &&
+			std::is_integral<typename __simd_pointer<Iterator>::element_type>::value>::type type;
+	};
+
+	// Iterator is a pointer to value_type T, so a value of T can be looked for
+	template <typename Iterator, typename T>
+	struct __simd_search {
+		typedef typename __bool_type<
+			std::is_same<typename __simd_pointer<Iterator>::type, __true_type>::value &&
+			std::is_same<typename __simd_pointer<Iterator>::element_type, T>::value>::type type;
+	};
+
+	// both iterators are pointers to the same value type
+	template <typename Iterator1, typename Iterator2>
+	struct __simd_pointer_pair {
+		typedef typename __bool_type<
+			std::is_same<typename __simd_pointer<Iterator1>::type, __true_type>::value &&
+			std::is_same<typename __simd_pointer<Iterator1>::element_type,
+				typename __simd_pointer<Iterator2>::element_type>::value>::type type;
+	};
+
+	// the comparisons a kernel can make of each element with a value
+	enum __simd_compare {
+		simd_equal, simd_not_equal, simd_less, simd_less_equal, simd_greater, simd_greater_equal
+	};
+
+	//! O(1)
+	template <int Compare, typename T>
+	inline bool __simd_compare_scalar(const T& a, const T& b) {
+		switch (Compare) {
+		case simd_equal: return a == b;
+		case simd_not_equal: return a != b;
+		case simd_less: return a < b;
+		case simd_less_equal: return a <= b;
+		case simd_greater: return a > b;
+		default: return a >= b;
+		}
+	}
+
+	// the comparison an operator makes of its first argument with the second,
+	// and the one it makes with the arguments swapped
+	template <typename Operator>
+	struct __simd_operator {
+		typedef __false_type type;
+		static const int compare = simd_equal;
+		static const int swapped = simd_equal;
+	};
+
+	template <int Compare, int Swapped>
+	struct __simd_comparison {
+		typedef __true_type type;
+		static const int compare = Compare;
+		static const int swapped = Swapped;
+	};
+
+	template <typename T>
+	struct __simd_operator<equal_to<T> > : __simd_comparison<simd_equal, simd_equal> {};
+	template <typename T>
+	struct __simd_operator<not_equal_to<T> > : __simd_comparison<simd_not_equal, simd_not_equal> {};
+	template <typename T>
+	struct __simd_operator<less<T> > : __simd_comparison<simd_less, simd_greater> {};
+	template <typename T>
+	struct __simd_operator<less_equal<T> > : __simd_comparison<simd_less_equal, simd_greater_equal> {};
+	template <typename T>
+	struct __simd_operator<greater<T> > : __simd_comparison<simd_greater, simd_less> {};
+	template <typename T>
+	struct __simd_operator<greater_equal<T> > : __simd_comparison<simd_greater_equal, simd_less_equal> {};
+
+	// a predicate the kernels can run, a comparison of each element with a bound value
+	template <typename Predicate>
+	struct __simd_predicate {
+		typedef __false_type type;
+		typedef void argument_type;
+	};
+
+	// bind2nd(op, value)(e) is `e op value`
+	template <typename Operator>
+	struct __simd_predicate<binder2nd<Operator> > {
+		typedef typename __simd_operator<Operator>::type type;
+		typedef typename Operator::first_argument_type argument_type;
+		static const int compare = __simd_operator<Operator>::compare;
+
+		static argument_type value(const binder2nd<Operator>& pred) { return pred.y; }
+	};
+
+	// bind1st(op, value)(e) is `value op e`
+	template <typename Operator>
+	struct __simd_predicate<binder1st<Operator> > {
+		typedef typename __simd_operator<Operator>::type type;
+		typedef typename Operator::second_argument_type argument_type;
+		static const int compare = __simd_operator<Operator>::swapped;
+
+		static argument_type value(const binder1st<Operator>& pred) { return pred.x; }
+	};
+
+	// Iterator is a pointer to the argument type of a predicate the kernels can run
+	template <typename Iterator, typename Predicate>
+	struct __simd_count_if {
+		typedef typename __bool_type<
+			std::is_same<typename __simd_predicate<Predicate>::type, __true_type>::value &&
+			std::is_same<typename __simd_search<Iterator, typename __simd_predicate<Predicate>::argument_type>::type,
+				__true_type>::value>::type type;
+	};
+
+	enum __simd_arithmetic { simd_add, simd_multiply };
+
+	// the value x for which `x op y` is y, -0.0 keeps the sign of a zero it is added to
+	//! O(1)
+	template <int Arithmetic, typename T>
+	inline T __simd_identity() {
+		if (Arithmetic == simd_multiply)
+			return T(1);
+		return std::is_floating_point<T>::value ? -T(0) : T(0);
+	}
+
+	// integers are added up as the vector lanes do it, wrapped around in the unsigned type,
+	// the sums in another order must not overflow where the loop one element at a time did not
+	template <typename T>
+	struct __simd_wrapping {
+		typedef typename std::conditional<std::is_integral<T>::value,
+			std::make_unsigned<T>, std::common_type<T> >::type::type type;
+	};
+
+	//! O(1)
+	template <int Arithmetic, typename T>
+	inline T __simd_arithmetic_scalar(const T& a, const T& b) {
+		typedef typename __simd_wrapping<T>::type U;
+		return Arithmetic == simd_add ? T(U(a) + U(b)) : T(U(a) * U(b));
+	}
+
+	// an operator of stl_function.hpp the numeric kernels can run
+	template <typename Operator>
+	struct __simd_arithmetic_operator {
+		typedef __false_type type;
+		typedef void argument_type;
+		static const int arithmetic = simd_add;
+	};
+
+	template <typename T>
+	struct __simd_arithmetic_operator<plus<T> > {
+		typedef __true_type type;
+		typedef T argument_type;
+		static const int arithmetic = simd_add;
+	};
+
+	template <typename T>
+	struct __simd_arithmetic_operator<multiply<T> > {
+		typedef __true_type type;
+		typedef T argument_type;
+		static const int arithmetic = simd_multiply;
+	};
+
+	// T is a value the numeric kernels take, an integer of 4 or 8 bytes, float or double
+	template <typename T>
+	struct __simd_numeric_element {
+		typedef __false_type type;
+	};
+
+#ifdef __STL_SIMD
+	template <> struct __simd_numeric_element<int> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<unsigned int> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<long> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<unsigned long> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<long long> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<unsigned long long> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<float> { typedef __true_type type; };
+	template <> struct __simd_numeric_element<double> { typedef __true_type type; };
+#endif
+
+	// Iterator is a pointer to T and Operator is plus<T> or multiply<T>,
+	// the kernels add up in another order, which is the same answer for integers
+	// and for floating point values only when Reassociate says it may differ
+	template <typename Iterator, typename T, typename Operator, bool Reassociate>
+	struct __simd_numeric {
+		typedef typename __bool_type<
+			std::is_same<typename __simd_numeric_element<T>::type, __true_type>::value &&
+			std::is_same<typename __simd_pointer<Iterator>::element_type, T>::value &&
+			std::is_same<typename __simd_arithmetic_operator<Operator>::argument_type, T>::value &&
+			(std::is_integral<T>::value || Reassociate)>::type type;
+	};
+
+	// the sum of the products of two ranges of T
+	template <typename Iterator1, typename Iterator2, typename T, typename Operator1, typename Operator2, bool Reassociate>
+	struct __simd_dot {
+		typedef typename __bool_type<
+			std::is_same<typename __simd_numeric<Iterator1, T, Operator1, Reassociate>::type, __true_type>::value &&
+			std::is_same<typename __simd_pointer_pair<Iterator1, Iterator2>::type, __true_type>::value &&
+			std::is_same<Operator1, plus<T> >::value && std::is_same<Operator2, multiply<T> >::value>::type type;
+	};
+
+	// the partial sums of a range of T written through a T*
+	template <typename InputIterator, typename OutputIterator, typename Operator, bool Reassociate>
+	struct __simd_scan {
+		typedef typename __simd_pointer<InputIterator>::element_type element_type;
+		typedef typename __bool_type<
+			std::is_same<typename __simd_numeric<InputIterator, element_type, Operator, Reassociate>::type, __true_type>::value &&
+			std::is_same<OutputIterator, element_type*>::value>::type type;
+	};
+
+	//! scalar loops !//
+	// the kernels when there is no SIMD, and the tails of the vector loops
+
+	//! O(n)
+	template <typename T>
+	size_t __find_scalar(const T* first, const T* last, T value) {
+		const T* curr = first;
+		while (curr != last && !(*curr == value)) {
+			++curr;
+		}
+		return curr - first;
+	}
+
+	//! O(n)
+	template <int Compare, typename T>
+	size_t __count_scalar(const T* first, const T* last, T value) {
+		size_t n = 0;
+		for (; first != last; ++first) {
+			n += __simd_compare_scalar<Compare>(*first, value) ? 1 : 0;
+		}
+		return n;
+	}
+
+	//! O(n)
+	template <typename T>
+	size_t __mismatch_scalar(const T* first1, const T* last1, const T* first2) {
+		const T* curr = first1;
+		while (curr != last1 && *curr == *first2) {
+			++curr;
+			++first2;
+		}
+		return curr - first1;
+	}
+
+	// the offset of the first of two equal neighbours, last - first if there is none
+	//! O(n)
+	template <typename T>
+	size_t __adjacent_find_scalar(const T* first, const T* last) {
+		if (first == last)
+			return 0;
+		for (const T* curr = first; curr + 1 != last; ++curr) {
+			if (*curr == *(curr + 1))
+				return curr - first;
+		}
+		return last - first;
+	}
+
+	// the first element e for which no other x has `x Compare e`,
+	// min_element with simd_less and max_element with simd_greater
+	//! O(n)
+	template <int Compare, typename T>
+	size_t __extreme_scalar(const T* first, const T* last) {
+		const T* result = first;
+		for (const T* curr = first; curr != last; ++curr) {
+			if (__simd_compare_scalar<Compare>(*curr, *result))
+				result = curr;
+		}
+		return result - first;
+	}
+
+	// the first smallest and the last largest of a range that is not empty
+	//! O(n)
+	template <typename T>
+	void __minmax_scalar(const T* first, const T* last, size_t& min_offset, size_t& max_offset) {
+		const T* smallest = first;
+		const T* largest = first;
+		for (const T* curr = first + 1; curr != last; ++curr) {
+			if (*curr < *smallest)
+				smallest = curr;
+			if (!(*curr < *largest))
+				largest = curr;
+		}
+		min_offset = smallest - first;
+		max_offset = largest - first;
+	}
+
+	//! O(n)
+	template <int Arithmetic, typename T>
+	T __accumulate_scalar(const T* first, const T* last, T init) {
+		for (; first != last; ++first) {
+			init = __simd_arithmetic_scalar<Arithmetic>(init, *first);
+		}
+		return init;
+	}
+
+	//! O(n)
+	template <typename T>
+	T __inner_product_scalar(const T* first1, const T* last1, const T* first2, T init) {
+		for (; first1 != last1; ++first1, ++first2) {
+			init = __simd_arithmetic_scalar<simd_add>(init, __simd_arithmetic_scalar<simd_multiply>(*first1, *first2));
+		}
+		return init;
+	}
+
+	// sum is what the partial sums before first came to
+	//! O(n)
+	template <int Arithmetic, typename T>
+	void __partial_sum_scalar(const T* first, const T* last, T* result, T sum) {
+		for (; first != last; ++first, ++result) {
+			sum = __simd_arithmetic_scalar<Arithmetic>(sum, *first);
+			*result = sum;
+		}
+	}
+
+#ifdef __STL_SIMD
+
+	// a block of this many steps is reduced to its extreme value, only the
+	// block with the extreme value of the range is searched again for its position
+	const size_t __simd_block_steps = 256;
+
+	//! O(1)
+	inline unsigned __simd_ctz(uint64_t bits) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return unsigned(index);
+#else
+		return unsigned(__builtin_ctzll(bits));
+#endif
+	}
+
+	// the index of the highest bit set, bits is not 0
+	//! O(1)
+	inline unsigned __simd_highest(uint64_t bits) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, bits);
+		return unsigned(index);
+#else
+		return 63 - unsigned(__builtin_clzll(bits));
+#endif
+	}
+
+	//! lanes !//
+	// each comparison gives a mask of all one bits in the lanes where it holds,
+	// bits() takes one bit of each byte of a mask, so a lane of T has sizeof(T) bits
+
+	struct __sse2_vector {
+		typedef __m128i vec;
+		static const size_t bytes = 16;
+
+		static vec load(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+		static uint64_t bits(vec mask) { return uint64_t(unsigned(_mm_movemask_epi8(mask))); }
+		static vec flip(vec mask) { return _mm_xor_si128(mask, _mm_set1_epi32(-1)); }
+		static vec zero() { return _mm_setzero_si128(); }
+		static void store(void* p, vec v) { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+		// a where the mask is set, b elsewhere
+		static vec select(vec mask, vec a, vec b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+		// each byte of acc counts the masks that had the byte set
+		static vec count_bytes(vec acc, vec mask) { return _mm_sub_epi8(acc, mask); }
+		static uint64_t sum_bytes(vec acc) {
+			vec sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+			return uint64_t(_mm_cvtsi128_si64(sums)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+		}
+	};
+
+	// the integer comparisons of one lane size, gt is the signed one
+	template <size_t Size>
+	struct __sse2_integer;
+
+	template <>
+	struct __sse2_integer<1> : __sse2_vector {
+		static vec set1(uint64_t v) { return _mm_set1_epi8(char(v)); }
+		static vec sign() { return _mm_set1_epi8(char(0x80)); }
+		static vec eq(vec a, vec b) { return _mm_cmpeq_epi8(a, b); }
+		static vec signed_gt(vec a, vec b) { return _mm_cmpgt_epi8(a, b); }
+	};
+
+	template <>
+	struct __sse2_integer<2> : __sse2_vector {
+		static vec set1(uint64_t v) { return _mm_set1_epi16(short(v)); }
+		static vec sign() { return _mm_set1_epi16(short(0x8000)); }
+		static vec eq(vec a, vec b) { return _mm_cmpeq_epi16(a, b); }
+		static vec signed_gt(vec a, vec b) { return _mm_cmpgt_epi16(a, b); }
+	};
+
+	template <>
+	struct __sse2_integer<4> : __sse2_vector {
+		static vec set1(uint64_t v) { return _mm_set1_epi32(int(v)); }
+		static vec sign() { return _mm_set1_epi32(int(0x80000000u)); }
+		static vec eq(vec a, vec b) { return _mm_cmpeq_epi32(a, b); }
+		static vec signed_gt(vec a, vec b) { return _mm_cmpgt_epi32(a, b); }
+		static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+
+		// SSE2 multiplies the even lanes into 64 bits, the odd lanes are moved down to be multiplied
+		static vec mul(vec a, vec b) {
+			vec even = _mm_mul_epu32(a, b);
+			vec odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+				_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		}
+	};
+
+	// SSE2 has no 64-bit comparison, the two halves of each lane are compared
+	template <>
+	struct __sse2_integer<8> : __sse2_vector {
+		static vec set1(uint64_t v) { return _mm_set1_epi64x((long long)v); }
+		static vec sign() { return _mm_set1_epi64x((long long)0x8000000000000000ULL); }
+
+		static vec eq(vec a, vec b) {
+			vec halves = _mm_cmpeq_epi32(a, b);
+			return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+
+		static vec signed_gt(vec a, vec b) {
+			// the low halves are compared unsigned, the high ones signed
+			const vec low_sign = _mm_set1_epi64x(0x80000000LL);
+			vec gt = _mm_cmpgt_epi32(_mm_xor_si128(a, low_sign), _mm_xor_si128(b, low_sign));
+			vec high_eq = _mm_cmpeq_epi32(a, b);
+			vec low_gt = _mm_shuffle_epi32(gt, _MM_SHUFFLE(2, 2, 0, 0));
+			vec result = _mm_or_si128(gt, _mm_and_si128(high_eq, low_gt));
+			return _mm_shuffle_epi32(result, _MM_SHUFFLE(3, 3, 1, 1));
+		}
+
+		static vec add(vec a, vec b) { return _mm_add_epi64(a, b); }
+
+		// the low 64 bits of the product, the high halves only meet the low ones
+		static vec mul(vec a, vec b) {
+			vec low = _mm_mul_epu32(a, b);
+			vec cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+			return _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+		}
+	};
+
+	template <typename T, bool Floating = std::is_floating_point<T>::value>
+	struct __sse2_lanes : __sse2_integer<sizeof(T)> {
+		typedef __sse2_integer<sizeof(T)> base;
+		typedef typename base::vec vec;
+
+		static vec set1(T v) { return base::set1(uint64_t(v)); }
+		static vec ne(vec a, vec b) { return base::flip(base::eq(a, b)); }
+
+		// unsigned lanes are compared signed with the sign bits flipped
+		static vec gt(vec a, vec b) {
+			if (std::is_signed<T>::value)
+				return base::signed_gt(a, b);
+			return base::signed_gt(_mm_xor_si128(a, base::sign()), _mm_xor_si128(b, base::sign()));
+		}
+		static vec lt(vec a, vec b) { return gt(b, a); }
+		static vec le(vec a, vec b) { return base::flip(gt(a, b)); }
+		static vec ge(vec a, vec b) { return base::flip(gt(b, a)); }
+	};
+
+	// a comparison with NaN is false, except ne
+	template <>
+	struct __sse2_lanes<float, true> : __sse2_vector {
+		static vec set1(float v) { return _mm_castps_si128(_mm_set1_ps(v)); }
+		static vec eq(vec a, vec b) { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec ne(vec a, vec b) { return _mm_castps_si128(_mm_cmpneq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec lt(vec a, vec b) { return _mm_castps_si128(_mm_cmplt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec le(vec a, vec b) { return _mm_castps_si128(_mm_cmple_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec gt(vec a, vec b) { return _mm_castps_si128(_mm_cmpgt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec ge(vec a, vec b) { return _mm_castps_si128(_mm_cmpge_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec add(vec a, vec b) { return _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static vec mul(vec a, vec b) { return _mm_castps_si128(_mm_mul_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+	};
+
+	template <>
+	struct __sse2_lanes<double, true> : __sse2_vector {
+		static vec set1(double v) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+		static vec eq(vec a, vec b) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec ne(vec a, vec b) { return _mm_castpd_si128(_mm_cmpneq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec lt(vec a, vec b) { return _mm_castpd_si128(_mm_cmplt_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec le(vec a, vec b) { return _mm_castpd_si128(_mm_cmple_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec gt(vec a, vec b) { return _mm_castpd_si128(_mm_cmpgt_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec ge(vec a, vec b) { return _mm_castpd_si128(_mm_cmpge_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec add(vec a, vec b) { return _mm_castpd_si128(_mm_add_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+		static vec mul(vec a, vec b) { return _mm_castpd_si128(_mm_mul_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+	};
+
+	template <int Compare, typename Lanes>
+	inline typename Lanes::vec __sse2_compare(typename Lanes::vec a, typename Lanes::vec b) {
+		switch (Compare) {
+		case simd_equal: return Lanes::eq(a, b);
+		case simd_not_equal: return Lanes::ne(a, b);
+		case simd_less: return Lanes::lt(a, b);
+		case simd_less_equal: return Lanes::le(a, b);
+		case simd_greater: return Lanes::gt(a, b);
+		default: return Lanes::ge(a, b);
+		}
+	}
+
+	template <int Arithmetic, typename Lanes>
+	inline typename Lanes::vec __sse2_arithmetic(typename Lanes::vec a, typename Lanes::vec b) {
+		return Arithmetic == simd_add ? Lanes::add(a, b) : Lanes::mul(a, b);
+	}
+
+	// the lanes of one size moved up, the lanes moved in are taken from fill
+	template <size_t Size>
+	struct __sse2_shift;
+
+	template <>
+	struct __sse2_shift<4> : __sse2_vector {
+		static vec up1(vec v, vec fill) { return _mm_or_si128(_mm_slli_si128(v, 4), _mm_srli_si128(fill, 12)); }
+		static vec up2(vec v, vec fill) { return _mm_or_si128(_mm_slli_si128(v, 8), _mm_srli_si128(fill, 8)); }
+		static vec last(vec v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)); }
+	};
+
+	template <>
+	struct __sse2_shift<8> : __sse2_vector {
+		static vec up1(vec v, vec fill) { return _mm_or_si128(_mm_slli_si128(v, 8), _mm_srli_si128(fill, 8)); }
+		static vec last(vec v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2)); }
+	};
+
+	// each lane of x becomes the lanes up to it added up (or multiplied), in log2(lanes) steps
+	template <int Arithmetic, typename T>
+	inline __m128i __sse2_prefix(__m128i x, __m128i identity) {
+		typedef __sse2_lanes<T> lanes;
+		typedef __sse2_shift<sizeof(T)> shift;
+		x = __sse2_arithmetic<Arithmetic, lanes>(x, shift::up1(x, identity));
+		if (sizeof(T) == 4)
+			x = __sse2_arithmetic<Arithmetic, lanes>(x, __sse2_shift<4>::up2(x, identity));
+		return x;
+	}
+
+	// every function of the AVX2 lanes and kernels is compiled for AVX2,
+	// a __m256i is never passed to a function compiled without it
+
+	struct __avx2_vector {
+		typedef __m256i vec;
+		static const size_t bytes = 32;
+
+		__STL_AVX2_TARGET static vec load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+		__STL_AVX2_TARGET static uint64_t bits(vec mask) { return uint64_t(unsigned(_mm256_movemask_epi8(mask))); }
+		__STL_AVX2_TARGET static vec flip(vec mask) { return _mm256_xor_si256(mask, _mm256_set1_epi32(-1)); }
+		__STL_AVX2_TARGET static vec zero() { return _mm256_setzero_si256(); }
+		__STL_AVX2_TARGET static void store(void* p, vec v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+		__STL_AVX2_TARGET static vec select(vec mask, vec a, vec b) { return _mm256_blendv_epi8(b, a, mask); }
+
+		__STL_AVX2_TARGET static vec count_bytes(vec acc, vec mask) { return _mm256_sub_epi8(acc, mask); }
+		__STL_AVX2_TARGET static uint64_t sum_bytes(vec acc) {
+			__m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+			__m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+			return uint64_t(_mm_cvtsi128_si64(half)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half)));
+		}
+	};
+
+	template <size_t Size>
+	struct __avx2_integer;
+
+	template <>
+	struct __avx2_integer<1> : __avx2_vector {
+		__STL_AVX2_TARGET static vec set1(uint64_t v) { return _mm256_set1_epi8(char(v)); }
+		__STL_AVX2_TARGET static vec sign() { return _mm256_set1_epi8(char(0x80)); }
+		__STL_AVX2_TARGET static vec eq(vec a, vec b) { return _mm256_cmpeq_epi8(a, b); }
+		__STL_AVX2_TARGET static vec signed_gt(vec a, vec b) { return _mm256_cmpgt_epi8(a, b); }
+	};
+
+	template <>
+	struct __avx2_integer<2> : __avx2_vector {
+		__STL_AVX2_TARGET static vec set1(uint64_t v) { return _mm256_set1_epi16(short(v)); }
+		__STL_AVX2_TARGET static vec sign() { return _mm256_set1_epi16(short(0x8000)); }
+		__STL_AVX2_TARGET static vec eq(vec a, vec b) { return _mm256_cmpeq_epi16(a, b); }
+		__STL_AVX2_TARGET static vec signed_gt(vec a, vec b) { return _mm256_cmpgt_epi16(a, b); }
+	};
+
+	template <>
+	struct __avx2_integer<4> : __avx2_vector {
+		__STL_AVX2_TARGET static vec set1(uint64_t v) { return _mm256_set1_epi32(int(v)); }
+		__STL_AVX2_TARGET static vec sign() { return _mm256_set1_epi32(int(0x80000000u)); }
+		__STL_AVX2_TARGET static vec eq(vec a, vec b) { return _mm256_cmpeq_epi32(a, b); }
+		__STL_AVX2_TARGET static vec signed_gt(vec a, vec b) { return _mm256_cmpgt_epi32(a, b); }
+		__STL_AVX2_TARGET static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+		__STL_AVX2_TARGET static vec mul(vec a, vec b) { return _mm256_mullo_epi32(a, b); }
+	};
+
+	template <>
+	struct __avx2_integer<8> : __avx2_vector {
+		__STL_AVX2_TARGET static vec set1(uint64_t v) { return _mm256_set1_epi64x((long long)v); }
+		__STL_AVX2_TARGET static vec sign() { return _mm256_set1_epi64x((long long)0x8000000000000000ULL); }
+		__STL_AVX2_TARGET static vec eq(vec a, vec b) { return _mm256_cmpeq_epi64(a, b); }
+		__STL_AVX2_TARGET static vec signed_gt(vec a, vec b) { return _mm256_cmpgt_epi64(a, b); }
+		__STL_AVX2_TARGET static vec add(vec a, vec b) { return _mm256_add_epi64(a, b); }
+
+		// AVX2 has no 64-bit multiply either
+		__STL_AVX2_TARGET static vec mul(vec a, vec b) {
+			vec low = _mm256_mul_epu32(a, b);
+			vec cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+				_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+			return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+		}
+	};
+
+	template <typename T, bool Floating = std::is_floating_point<T>::value>
+	struct __avx2_lanes : __avx2_integer<sizeof(T)> {
+		typedef __avx2_integer<sizeof(T)> base;
+		typedef typename base::vec vec;
+
+		__STL_AVX2_TARGET static vec set1(T v) { return base::set1(uint64_t(v)); }
+		__STL_AVX2_TARGET static vec ne(vec a, vec b) { return base::flip(base::eq(a, b)); }
+
+		__STL_AVX2_TARGET static vec gt(vec a, vec b) {
+			if (std::is_signed<T>::value)
+				return base::signed_gt(a, b);
+			return base::signed_gt(_mm256_xor_si256(a, base::sign()), _mm256_xor_si256(b, base::sign()));
+		}
+		__STL_AVX2_TARGET static vec lt(vec a, vec b) { return gt(b, a); }
+		__STL_AVX2_TARGET static vec le(vec a, vec b) { return base::flip(gt(a, b)); }
+		__STL_AVX2_TARGET static vec ge(vec a, vec b) { return base::flip(gt(b, a)); }
+	};
+
+	template <>
+	struct __avx2_lanes<float, true> : __avx2_vector {
+		__STL_AVX2_TARGET static __m256 cast(vec a) { return _mm256_castsi256_ps(a); }
+		__STL_AVX2_TARGET static vec set1(float v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+		__STL_AVX2_TARGET static vec eq(vec a, vec b) { return _mm256_castps_si256(_mm256_cmp_ps(cast(a), cast(b), _CMP_EQ_OQ)); }
+		__STL_AVX2_TARGET static vec ne(vec a, vec b) { return _mm256_castps_si256(_mm256_cmp_ps(cast(a), cast(b), _CMP_NEQ_UQ)); }
+		__STL_AVX2_TARGET static vec lt(vec a, vec b) { return _mm256_castps_si256(_mm256_cmp_ps(cast(a), cast(b), _CMP_LT_OQ)); }
+		__STL_AVX2_TARGET static vec le(vec a, vec b) { return _mm256_castps_si256(_mm256_cmp_ps(cast(a), cast(b), _CMP_LE_OQ)); }
+		__STL_AVX2_TARGET static vec gt(vec a, vec b) { return _mm256_castps_si256(_mm256_cmp_ps(cast(a), cast(b), _CMP_GT_OQ)); }
+		__STL_AVX2_TARGET static vec ge(vec a, vec b) { return _mm256_castps_si256(_mm256_cmp_ps(cast(a), cast(b), _CMP_GE_OQ)); }
+		__STL_AVX2_TARGET static vec add(vec a, vec b) { return _mm256_castps_si256(_mm256_add_ps(cast(a), cast(b))); }
+		__STL_AVX2_TARGET static vec mul(vec a, vec b) { return _mm256_castps_si256(_mm256_mul_ps(cast(a), cast(b))); }
+	};
+
+	template <>
+	struct __avx2_lanes<double, true> : __avx2_vector {
+		__STL_AVX2_TARGET static __m256d cast(vec a) { return _mm256_castsi256_pd(a); }
+		__STL_AVX2_TARGET static vec set1(double v) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+		__STL_AVX2_TARGET static vec eq(vec a, vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(cast(a), cast(b), _CMP_EQ_OQ)); }
+		__STL_AVX2_TARGET static vec ne(vec a, vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(cast(a), cast(b), _CMP_NEQ_UQ)); }
+		__STL_AVX2_TARGET static vec lt(vec a, vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(cast(a), cast(b), _CMP_LT_OQ)); }
+		__STL_AVX2_TARGET static vec le(vec a, vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(cast(a), cast(b), _CMP_LE_OQ)); }
+		__STL_AVX2_TARGET static vec gt(vec a, vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(cast(a), cast(b), _CMP_GT_OQ)); }
+		__STL_AVX2_TARGET static vec ge(vec a, vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(cast(a), cast(b), _CMP_GE_OQ)); }
+		__STL_AVX2_TARGET static vec add(vec a, vec b) { return _mm256_castpd_si256(_mm256_add_pd(cast(a), cast(b))); }
+		__STL_AVX2_TARGET static vec mul(vec a, vec b) { return _mm256_castpd_si256(_mm256_mul_pd(cast(a), cast(b))); }
+	};
+
+	template <int Compare, typename Lanes>
+	__STL_AVX2_TARGET inline typename Lanes::vec __avx2_compare(typename Lanes::vec a, typename Lanes::vec b) {
+		switch (Compare) {
+		case simd_equal: return Lanes::eq(a, b);
+		case simd_not_equal: return Lanes::ne(a, b);
+		case simd_less: return Lanes::lt(a, b);
+		case simd_less_equal: return Lanes::le(a, b);
+		case simd_greater: return Lanes::gt(a, b);
+		default: return Lanes::ge(a, b);
+		}
+	}
+
+	template <int Arithmetic, typename Lanes>
+	__STL_AVX2_TARGET inline typename Lanes::vec __avx2_arithmetic(typename Lanes::vec a, typename Lanes::vec b) {
+		return Arithmetic == simd_add ? Lanes::add(a, b) : Lanes::mul(a, b);
+	}
+
+	// the byte shifts stay in each half of 16 bytes, the top lane of the
+	// low half is carried into the high half apart
+	template <size_t Size>
+	struct __avx2_shift;
+
+	template <>
+	struct __avx2_shift<4> : __avx2_vector {
+		__STL_AVX2_TARGET static vec up1(vec v, vec fill) { return _mm256_or_si256(_mm256_slli_si256(v, 4), _mm256_srli_si256(fill, 12)); }
+		__STL_AVX2_TARGET static vec up2(vec v, vec fill) { return _mm256_or_si256(_mm256_slli_si256(v, 8), _mm256_srli_si256(fill, 8)); }
+		// the top lane of the low half in every lane of the high half, fill in the low half
+		__STL_AVX2_TARGET static vec carry(vec v, vec fill) {
+			return _mm256_permute2x128_si256(_mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)), fill, 0x02);
+		}
+		__STL_AVX2_TARGET static vec last(vec v) { return _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(7)); }
+	};
+
+	template <>
+	struct __avx2_shift<8> : __avx2_vector {
+		__STL_AVX2_TARGET static vec up1(vec v, vec fill) { return _mm256_or_si256(_mm256_slli_si256(v, 8), _mm256_srli_si256(fill, 8)); }
+		__STL_AVX2_TARGET static vec carry(vec v, vec fill) {
+			return _mm256_permute2x128_si256(_mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2)), fill, 0x02);
+		}
+		__STL_AVX2_TARGET static vec last(vec v) { return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3)); }
+	};
+
+	template <int Arithmetic, typename T>
+	__STL_AVX2_TARGET inline __m256i __avx2_prefix(__m256i x, __m256i identity) {
+		typedef __avx2_lanes<T> lanes;
+		typedef __avx2_shift<sizeof(T)> shift;
+		x = __avx2_arithmetic<Arithmetic, lanes>(x, shift::up1(x, identity));
+		if (sizeof(T) == 4)
+			x = __avx2_arithmetic<Arithmetic, lanes>(x, __avx2_shift<4>::up2(x, identity));
+		return __avx2_arithmetic<Arithmetic, lanes>(x, shift::carry(x, identity));
+	}
+
+	//! SSE2 kernels !//
+	// two vectors, 32 bytes, in each step of the main loop
+
+	//! O(n)
+	template <typename T>
+	size_t __find_sse2(const T* first, const T* last, T value) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec target = lanes::set1(value);
+		const T* curr = first;
+		for (; size_t(last - curr) >= 2 * step; curr += 2 * step) {
+			uint64_t bits = lanes::bits(lanes::eq(lanes::load(curr), target))
+				| lanes::bits(lanes::eq(lanes::load(curr + step), target)) << lanes::bytes;
+			if (bits != 0)
+				return (curr - first) + __simd_ctz(bits) / sizeof(T);
+		}
+		return (curr - first) + __find_scalar(curr, last, value);
+	}
+
+	//! O(n)
+	template <int Compare, typename T>
+	size_t __count_sse2(const T* first, const T* last, T value) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec target = lanes::set1(value);
+		size_t bytes = 0;
+		while (size_t(last - first) >= 2 * step) {
+			// a byte of acc goes up by at most 2 in a step, it is added up before it wraps
+			size_t steps = size_t(last - first) / (2 * step);
+			steps = steps < 127 ? steps : 127;
+			const T* block_last = first + steps * 2 * step;
+			vec acc = lanes::zero();
+			for (; first != block_last; first += 2 * step) {
+				acc = lanes::count_bytes(acc, __sse2_compare<Compare, lanes>(lanes::load(first), target));
+				acc = lanes::count_bytes(acc, __sse2_compare<Compare, lanes>(lanes::load(first + step), target));
+			}
+			bytes += lanes::sum_bytes(acc);
+		}
+		return bytes / sizeof(T) + __count_scalar<Compare>(first, last, value);
+	}
+
+	//! O(n)
+	template <typename T>
+	size_t __mismatch_sse2(const T* first1, const T* last1, const T* first2) {
+		typedef __sse2_lanes<T> lanes;
+		const size_t step = lanes::bytes / sizeof(T);
+		const T* curr = first1;
+		for (; size_t(last1 - curr) >= 2 * step; curr += 2 * step, first2 += 2 * step) {
+			uint64_t bits = lanes::bits(lanes::ne(lanes::load(curr), lanes::load(first2)))
+				| lanes::bits(lanes::ne(lanes::load(curr + step), lanes::load(first2 + step))) << lanes::bytes;
+			if (bits != 0)
+				return (curr - first1) + __simd_ctz(bits) / sizeof(T);
+		}
+		return (curr - first1) + __mismatch_scalar(curr, last1, first2);
+	}
+
+	// each element is compared with the next one, loaded one element on
+	//! O(n)
+	template <typename T>
+	size_t __adjacent_find_sse2(const T* first, const T* last) {
+		typedef __sse2_lanes<T> lanes;
+		const size_t step = lanes::bytes / sizeof(T);
+		const T* curr = first;
+		for (; size_t(last - curr) > 2 * step; curr += 2 * step) {
+			uint64_t bits = lanes::bits(lanes::eq(lanes::load(curr), lanes::load(curr + 1)))
+				| lanes::bits(lanes::eq(lanes::load(curr + step), lanes::load(curr + step + 1))) << lanes::bytes;
+			if (bits != 0)
+				return (curr - first) + __simd_ctz(bits) / sizeof(T);
+		}
+		size_t offset = __adjacent_find_scalar(curr, last);
+		return curr + offset == last ? last - first : (curr - first) + offset;
+	}
+
+	// the extreme of the lanes of acc and of best, true if it is beyond best
+	template <int Compare, typename T, typename Lanes>
+	bool __reduce_extreme(typename Lanes::vec acc, T& best) {
+		T lanes_of[Lanes::bytes / sizeof(T)];
+		Lanes::store(lanes_of, acc);
+		bool beyond = false;
+		for (size_t i = 0; i < Lanes::bytes / sizeof(T); ++i) {
+			if (__simd_compare_scalar<Compare>(lanes_of[i], best)) {
+				best = lanes_of[i];
+				beyond = true;
+			}
+		}
+		return beyond;
+	}
+
+	// the accumulators start from the best value so far, a NaN never takes its place,
+	// *first is not NaN
+	//! O(n)
+	template <int Compare, typename T>
+	size_t __extreme_sse2(const T* first, const T* last) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		T best = *first;
+		const T* best_first = first;
+		const T* best_last = first;
+		const T* curr = first;
+		while (size_t(last - curr) >= 2 * step) {
+			size_t steps = size_t(last - curr) / (2 * step);
+			steps = steps < __simd_block_steps ? steps : __simd_block_steps;
+			const T* block_first = curr;
+			const T* block_last = curr + steps * 2 * step;
+			vec acc0 = lanes::set1(best);
+			vec acc1 = acc0;
+			for (; curr != block_last; curr += 2 * step) {
+				vec x0 = lanes::load(curr);
+				vec x1 = lanes::load(curr + step);
+				acc0 = lanes::select(__sse2_compare<Compare, lanes>(x0, acc0), x0, acc0);
+				acc1 = lanes::select(__sse2_compare<Compare, lanes>(x1, acc1), x1, acc1);
+			}
+			acc0 = lanes::select(__sse2_compare<Compare, lanes>(acc1, acc0), acc1, acc0);
+			if (__reduce_extreme<Compare, T, lanes>(acc0, best)) {
+				best_first = block_first;
+				best_last = block_last;
+			}
+		}
+		size_t result = best_first == best_last ? 0 : (best_first - first) + __find_sse2(best_first, best_last, best);
+		for (; curr != last; ++curr) {
+			if (__simd_compare_scalar<Compare>(*curr, best)) {
+				best = *curr;
+				result = curr - first;
+			}
+		}
+		return result;
+	}
+
+	// the last position of value in [first, last), which has it
+	//! O(n)
+	template <typename T>
+	size_t __find_last_sse2(const T* first, const T* last, T value) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec target = lanes::set1(value);
+		const T* curr = last;
+		while (size_t(curr - first) >= step) {
+			curr -= step;
+			uint64_t bits = lanes::bits(lanes::eq(lanes::load(curr), target));
+			if (bits != 0)
+				return (curr - first) + __simd_highest(bits) / sizeof(T);
+		}
+		while (!(*--curr == value)) {}
+		return curr - first;
+	}
+
+	// integers only, the accumulators of a block start from its first element,
+	// so the extremes of a block are in it
+	//! O(n)
+	template <typename T>
+	void __minmax_sse2(const T* first, const T* last, size_t& min_offset, size_t& max_offset) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		T smallest = *first;
+		T largest = *first;
+		const T* min_first = first;
+		const T* min_last = first;
+		const T* max_first = first;
+		const T* max_last = first;
+		const T* curr = first;
+		while (size_t(last - curr) >= 2 * step) {
+			size_t steps = size_t(last - curr) / (2 * step);
+			steps = steps < __simd_block_steps ? steps : __simd_block_steps;
+			const T* block_first = curr;
+			const T* block_last = curr + steps * 2 * step;
+			vec min0 = lanes::set1(*curr);
+			vec min1 = min0;
+			vec max0 = min0;
+			vec max1 = min0;
+			for (; curr != block_last; curr += 2 * step) {
+				vec x0 = lanes::load(curr);
+				vec x1 = lanes::load(curr + step);
+				min0 = lanes::select(lanes::lt(x0, min0), x0, min0);
+				min1 = lanes::select(lanes::lt(x1, min1), x1, min1);
+				max0 = lanes::select(lanes::gt(x0, max0), x0, max0);
+				max1 = lanes::select(lanes::gt(x1, max1), x1, max1);
+			}
+			min0 = lanes::select(lanes::lt(min1, min0), min1, min0);
+			max0 = lanes::select(lanes::gt(max1, max0), max1, max0);
+			if (__reduce_extreme<simd_less, T, lanes>(min0, smallest)) {
+				min_first = block_first;
+				min_last = block_last;
+			}
+			// a later block with the same largest value takes its place
+			T block_largest = *block_first;
+			__reduce_extreme<simd_greater, T, lanes>(max0, block_largest);
+			if (!(block_largest < largest)) {
+				largest = block_largest;
+				max_first = block_first;
+				max_last = block_last;
+			}
+		}
+		min_offset = min_first == min_last ? 0 : (min_first - first) + __find_sse2(min_first, min_last, smallest);
+		max_offset = max_first == max_last ? 0 : (max_first - first) + __find_last_sse2(max_first, max_last, largest);
+		for (; curr != last; ++curr) {
+			if (*curr < smallest) {
+				smallest = *curr;
+				min_offset = curr - first;
+			}
+			if (!(*curr < largest)) {
+				largest = *curr;
+				max_offset = curr - first;
+			}
+		}
+	}
+
+	//! numeric kernels !//
+	// four vectors in each step, so that four sums are on the way at once,
+	// the lanes of the accumulators are added up at the end
+
+	//! O(n)
+	template <int Arithmetic, typename T>
+	T __accumulate_sse2(const T* first, const T* last, T init) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		vec acc0 = lanes::set1(__simd_identity<Arithmetic, T>());
+		vec acc1 = acc0;
+		vec acc2 = acc0;
+		vec acc3 = acc0;
+		for (; size_t(last - first) >= 4 * step; first += 4 * step) {
+			acc0 = __sse2_arithmetic<Arithmetic, lanes>(acc0, lanes::load(first));
+			acc1 = __sse2_arithmetic<Arithmetic, lanes>(acc1, lanes::load(first + step));
+			acc2 = __sse2_arithmetic<Arithmetic, lanes>(acc2, lanes::load(first + 2 * step));
+			acc3 = __sse2_arithmetic<Arithmetic, lanes>(acc3, lanes::load(first + 3 * step));
+		}
+		acc0 = __sse2_arithmetic<Arithmetic, lanes>(__sse2_arithmetic<Arithmetic, lanes>(acc0, acc1),
+			__sse2_arithmetic<Arithmetic, lanes>(acc2, acc3));
+		T lanes_of[lanes::bytes / sizeof(T)];
+		lanes::store(lanes_of, acc0);
+		for (size_t i = 0; i < step; ++i) {
+			init = __simd_arithmetic_scalar<Arithmetic>(init, lanes_of[i]);
+		}
+		return __accumulate_scalar<Arithmetic>(first, last, init);
+	}
+
+	//! O(n)
+	template <typename T>
+	T __inner_product_sse2(const T* first1, const T* last1, const T* first2, T init) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		vec acc0 = lanes::set1(__simd_identity<simd_add, T>());
+		vec acc1 = acc0;
+		vec acc2 = acc0;
+		vec acc3 = acc0;
+		for (; size_t(last1 - first1) >= 4 * step; first1 += 4 * step, first2 += 4 * step) {
+			acc0 = lanes::add(acc0, lanes::mul(lanes::load(first1), lanes::load(first2)));
+			acc1 = lanes::add(acc1, lanes::mul(lanes::load(first1 + step), lanes::load(first2 + step)));
+			acc2 = lanes::add(acc2, lanes::mul(lanes::load(first1 + 2 * step), lanes::load(first2 + 2 * step)));
+			acc3 = lanes::add(acc3, lanes::mul(lanes::load(first1 + 3 * step), lanes::load(first2 + 3 * step)));
+		}
+		acc0 = lanes::add(lanes::add(acc0, acc1), lanes::add(acc2, acc3));
+		T lanes_of[lanes::bytes / sizeof(T)];
+		lanes::store(lanes_of, acc0);
+		for (size_t i = 0; i < step; ++i) {
+			init = __simd_arithmetic_scalar<simd_add>(init, lanes_of[i]);
+		}
+		return __inner_product_scalar(first1, last1, first2, init);
+	}
+
+	// each vector is summed up in its lanes, then the sum of all before it
+	// is added to every lane, result may be first
+	//! O(n)
+	template <int Arithmetic, typename T>
+	void __partial_sum_sse2(const T* first, const T* last, T* result) {
+		typedef __sse2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		typedef __sse2_shift<sizeof(T)> shift;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec identity = lanes::set1(__simd_identity<Arithmetic, T>());
+		vec sum = identity;
+		for (; size_t(last - first) >= 2 * step; first += 2 * step, result += 2 * step) {
+			vec x0 = __sse2_prefix<Arithmetic, T>(lanes::load(first), identity);
+			vec x1 = __sse2_prefix<Arithmetic, T>(lanes::load(first + step), identity);
+			// only the sum before the step waits for the step before
+			x1 = __sse2_arithmetic<Arithmetic, lanes>(shift::last(x0), x1);
+			x0 = __sse2_arithmetic<Arithmetic, lanes>(sum, x0);
+			x1 = __sse2_arithmetic<Arithmetic, lanes>(sum, x1);
+			sum = shift::last(x1);
+			lanes::store(result, x0);
+			lanes::store(result + step, x1);
+		}
+		T lanes_of[lanes::bytes / sizeof(T)];
+		lanes::store(lanes_of, sum);
+		__partial_sum_scalar<Arithmetic>(first, last, result, lanes_of[0]);
+	}
+
+	//! AVX2 kernels !//
+	// the same loops as the SSE2 ones, with two vectors of 32 bytes in each step
+
+	//! O(n)
+	template <typename T>
+	__STL_AVX2_TARGET size_t __find_avx2(const T* first, const T* last, T value) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec target = lanes::set1(value);
+		const T* curr = first;
+		for (; size_t(last - curr) >= 2 * step; curr += 2 * step) {
+			uint64_t bits = lanes::bits(lanes::eq(lanes::load(curr), target))
+				| lanes::bits(lanes::eq(lanes::load(curr + step), target)) << lanes::bytes;
+			if (bits != 0)
+				return (curr - first) + __simd_ctz(bits) / sizeof(T);
+		}
+		return (curr - first) + __find_scalar(curr, last, value);
+	}
+
+	//! O(n)
+	template <int Compare, typename T>
+	__STL_AVX2_TARGET size_t __count_avx2(const T* first, const T* last, T value) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec target = lanes::set1(value);
+		size_t bytes = 0;
+		while (size_t(last - first) >= 2 * step) {
+			size_t steps = size_t(last - first) / (2 * step);
+			steps = steps < 127 ? steps : 127;
+			const T* block_last = first + steps * 2 * step;
+			vec acc = lanes::zero();
+			for (; first != block_last; first += 2 * step) {
+				acc = lanes::count_bytes(acc, __avx2_compare<Compare, lanes>(lanes::load(first), target));
+				acc = lanes::count_bytes(acc, __avx2_compare<Compare, lanes>(lanes::load(first + step), target));
+			}
+			bytes += lanes::sum_bytes(acc);
+		}
+		return bytes / sizeof(T) + __count_scalar<Compare>(first, last, value);
+	}
+
+	//! O(n)
+	template <typename T>
+	__STL_AVX2_TARGET size_t __mismatch_avx2(const T* first1, const T* last1, const T* first2) {
+		typedef __avx2_lanes<T> lanes;
+		const size_t step = lanes::bytes / sizeof(T);
+		const T* curr = first1;
+		for (; size_t(last1 - curr) >= 2 * step; curr += 2 * step, first2 += 2 * step) {
+			uint64_t bits = lanes::bits(lanes::ne(lanes::load(curr), lanes::load(first2)))
+				| lanes::bits(lanes::ne(lanes::load(curr + step), lanes::load(first2 + step))) << lanes::bytes;
+			if (bits != 0)
+				return (curr - first1) + __simd_ctz(bits) / sizeof(T);
+		}
+		return (curr - first1) + __mismatch_scalar(curr, last1, first2);
+	}
+
+	//! O(n)
+	template <typename T>
+	__STL_AVX2_TARGET size_t __adjacent_find_avx2(const T* first, const T* last) {
+		typedef __avx2_lanes<T> lanes;
+		const size_t step = lanes::bytes / sizeof(T);
+		const T* curr = first;
+		for (; size_t(last - curr) > 2 * step; curr += 2 * step) {
+			uint64_t bits = lanes::bits(lanes::eq(lanes::load(curr), lanes::load(curr + 1)))
+				| lanes::bits(lanes::eq(lanes::load(curr + step), lanes::load(curr + step + 1))) << lanes::bytes;
+			if (bits != 0)
+				return (curr - first) + __simd_ctz(bits) / sizeof(T);
+		}
+		size_t offset = __adjacent_find_scalar(curr, last);
+		return curr + offset == last ? last - first : (curr - first) + offset;
+	}
+
+	template <int Compare, typename T, typename Lanes>
+	__STL_AVX2_TARGET bool __reduce_extreme_avx2(typename Lanes::vec acc, T& best) {
+		T lanes_of[Lanes::bytes / sizeof(T)];
+		Lanes::store(lanes_of, acc);
+		bool beyond = false;
+		for (size_t i = 0; i < Lanes::bytes / sizeof(T); ++i) {
+			if (__simd_compare_scalar<Compare>(lanes_of[i], best)) {
+				best = lanes_of[i];
+				beyond = true;
+			}
+		}
+		return beyond;
+	}
+
+	//! O(n)
+	template <int Compare, typename T>
+	__STL_AVX2_TARGET size_t __extreme_avx2(const T* first, const T* last) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		T best = *first;
+		const T* best_first = first;
+		const T* best_last = first;
+		const T* curr = first;
+		while (size_t(last - curr) >= 2 * step) {
+			size_t steps = size_t(last - curr) / (2 * step);
+			steps = steps < __simd_block_steps ? steps : __simd_block_steps;
+			const T* block_first = curr;
+			const T* block_last = curr + steps * 2 * step;
+			vec acc0 = lanes::set1(best);
+			vec acc1 = acc0;
+			for (; curr != block_last; curr += 2 * step) {
+				vec x0 = lanes::load(curr);
+				vec x1 = lanes::load(curr + step);
+				acc0 = lanes::select(__avx2_compare<Compare, lanes>(x0, acc0), x0, acc0);
+				acc1 = lanes::select(__avx2_compare<Compare, lanes>(x1, acc1), x1, acc1);
+			}
+			acc0 = lanes::select(__avx2_compare<Compare, lanes>(acc1, acc0), acc1, acc0);
+			if (__reduce_extreme_avx2<Compare, T, lanes>(acc0, best)) {
+				best_first = block_first;
+				best_last = block_last;
+			}
+		}
+		size_t result = best_first == best_last ? 0 : (best_first - first) + __find_avx2(best_first, best_last, best);
+		for (; curr != last; ++curr) {
+			if (__simd_compare_scalar<Compare>(*curr, best)) {
+				best = *curr;
+				result = curr - first;
+			}
+		}
+		return result;
+	}
+
+	//! O(n)
+	template <typename T>
+	__STL_AVX2_TARGET size_t __find_last_avx2(const T* first, const T* last, T value) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec target = lanes::set1(value);
+		const T* curr = last;
+		while (size_t(curr - first) >= step) {
+			curr -= step;
+			uint64_t bits = lanes::bits(lanes::eq(lanes::load(curr), target));
+			if (bits != 0)
+				return (curr - first) + __simd_highest(bits) / sizeof(T);
+		}
+		while (!(*--curr == value)) {}
+		return curr - first;
+	}
+
+	//! O(n)
+	template <typename T>
+	__STL_AVX2_TARGET void __minmax_avx2(const T* first, const T* last, size_t& min_offset, size_t& max_offset) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		T smallest = *first;
+		T largest = *first;
+		const T* min_first = first;
+		const T* min_last = first;
+		const T* max_first = first;
+		const T* max_last = first;
+		const T* curr = first;
+		while (size_t(last - curr) >= 2 * step) {
+			size_t steps = size_t(last - curr) / (2 * step);
+			steps = steps < __simd_block_steps ? steps : __simd_block_steps;
+			const T* block_first = curr;
+			const T* block_last = curr + steps * 2 * step;
+			vec min0 = lanes::set1(*curr);
+			vec min1 = min0;
+			vec max0 = min0;
+			vec max1 = min0;
+			for (; curr != block_last; curr += 2 * step) {
+				vec x0 = lanes::load(curr);
+				vec x1 = lanes::load(curr + step);
+				min0 = lanes::select(lanes::lt(x0, min0), x0, min0);
+				min1 = lanes::select(lanes::lt(x1, min1), x1, min1);
+				max0 = lanes::select(lanes::gt(x0, max0), x0, max0);
+				max1 = lanes::select(lanes::gt(x1, max1), x1, max1);
+			}
+			min0 = lanes::select(lanes::lt(min1, min0), min1, min0);
+			max0 = lanes::select(lanes::gt(max1, max0), max1, max0);
+			if (__reduce_extreme_avx2<simd_less, T, lanes>(min0, smallest)) {
+				min_first = block_first;
+				min_last = block_last;
+			}
+			T block_largest = *block_first;
+			__reduce_extreme_avx2<simd_greater, T, lanes>(max0, block_largest);
+			if (!(block_largest < largest)) {
+				largest = block_largest;
+				max_first = block_first;
+				max_last = block_last;
+			}
+		}
+		min_offset = min_first == min_last ? 0 : (min_first - first) + __find_avx2(min_first, min_last, smallest);
+		max_offset = max_first == max_last ? 0 : (max_first - first) + __find_last_avx2(max_first, max_last, largest);
+		for (; curr != last; ++curr) {
+			if (*curr < smallest) {
+				smallest = *curr;
+				min_offset = curr - first;
+			}
+			if (!(*curr < largest)) {
+				largest = *curr;
+				max_offset = curr - first;
+			}
+		}
+	}
+
+	//! O(n)
+	template <int Arithmetic, typename T>
+	__STL_AVX2_TARGET T __accumulate_avx2(const T* first, const T* last, T init) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		vec acc0 = lanes::set1(__simd_identity<Arithmetic, T>());
+		vec acc1 = acc0;
+		vec acc2 = acc0;
+		vec acc3 = acc0;
+		for (; size_t(last - first) >= 4 * step; first += 4 * step) {
+			acc0 = __avx2_arithmetic<Arithmetic, lanes>(acc0, lanes::load(first));
+			acc1 = __avx2_arithmetic<Arithmetic, lanes>(acc1, lanes::load(first + step));
+			acc2 = __avx2_arithmetic<Arithmetic, lanes>(acc2, lanes::load(first + 2 * step));
+			acc3 = __avx2_arithmetic<Arithmetic, lanes>(acc3, lanes::load(first + 3 * step));
+		}
+		acc0 = __avx2_arithmetic<Arithmetic, lanes>(__avx2_arithmetic<Arithmetic, lanes>(acc0, acc1),
+			__avx2_arithmetic<Arithmetic, lanes>(acc2, acc3));
+		T lanes_of[lanes::bytes / sizeof(T)];
+		lanes::store(lanes_of, acc0);
+		for (size_t i = 0; i < step; ++i) {
+			init = __simd_arithmetic_scalar<Arithmetic>(init, lanes_of[i]);
+		}
+		return __accumulate_scalar<Arithmetic>(first, last, init);
+	}
+
+	//! O(n)
+	template <typename T>
+	__STL_AVX2_TARGET T __inner_product_avx2(const T* first1, const T* last1, const T* first2, T init) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		const size_t step = lanes::bytes / sizeof(T);
+		vec acc0 = lanes::set1(__simd_identity<simd_add, T>());
+		vec acc1 = acc0;
+		vec acc2 = acc0;
+		vec acc3 = acc0;
+		for (; size_t(last1 - first1) >= 4 * step; first1 += 4 * step, first2 += 4 * step) {
+			acc0 = lanes::add(acc0, lanes::mul(lanes::load(first1), lanes::load(first2)));
+			acc1 = lanes::add(acc1, lanes::mul(lanes::load(first1 + step), lanes::load(first2 + step)));
+			acc2 = lanes::add(acc2, lanes::mul(lanes::load(first1 + 2 * step), lanes::load(first2 + 2 * step)));
+			acc3 = lanes::add(acc3, lanes::mul(lanes::load(first1 + 3 * step), lanes::load(first2 + 3 * step)));
+		}
+		acc0 = lanes::add(lanes::add(acc0, acc1), lanes::add(acc2, acc3));
+		T lanes_of[lanes::bytes / sizeof(T)];
+		lanes::store(lanes_of, acc0);
+		for (size_t i = 0; i < step; ++i) {
+			init = __simd_arithmetic_scalar<simd_add>(init, lanes_of[i]);
+		}
+		return __inner_product_scalar(first1, last1, first2, init);
+	}
+
+	//! O(n)
+	template <int Arithmetic, typename T>
+	__STL_AVX2_TARGET void __partial_sum_avx2(const T* first, const T* last, T* result) {
+		typedef __avx2_lanes<T> lanes;
+		typedef typename lanes::vec vec;
+		typedef __avx2_shift<sizeof(T)> shift;
+		const size_t step = lanes::bytes / sizeof(T);
+		const vec identity = lanes::set1(__simd_identity<Arithmetic, T>());
+		vec sum = identity;
+		for (; size_t(last - first) >= 2 * step; first += 2 * step, result += 2 * step) {
+			vec x0 = __avx2_prefix<Arithmetic, T>(lanes::load(first), identity);
+			vec x1 = __avx2_prefix<Arithmetic, T>(lanes::load(first + step), identity);
+			x1 = __avx2_arithmetic<Arithmetic, lanes>(shift::last(x0), x1);
+			x0 = __avx2_arithmetic<Arithmetic, lanes>(sum, x0);
+			x1 = __avx2_arithmetic<Arithmetic, lanes>(sum, x1);
+			sum = shift::last(x1);
+			lanes::store(result, x0);
+			lanes::store(result + step, x1);
+		}
+		T lanes_of[lanes::bytes / sizeof(T)];
+		lanes::store(lanes_of, sum);
+		__partial_sum_scalar<Arithmetic>(first, last, result, lanes_of[0]);
+	}
+
+#endif // __STL_SIMD
+
+	//! dispatch !//
+	// the widest kernel the processor runs, the scalar loop without SIMD
+
+	//! O(n)
+	template <typename T>
+	inline size_t __simd_find(const T* first, const T* last, T value) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: return __find_avx2(first, last, value);
+		case simd_sse2: return __find_sse2(first, last, value);
+		}
+#endif
+		return __find_scalar(first, last, value);
+	}
+
+	// the number of elements e for which `e Compare value` holds
+	//! O(n)
+	template <int Compare, typename T>
+	inline size_t __simd_count(const T* first, const T* last, T value) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: return __count_avx2<Compare>(first, last, value);
+		case simd_sse2: return __count_sse2<Compare>(first, last, value);
+		}
+#endif
+		return __count_scalar<Compare>(first, last, value);
+	}
+
+	// the offset of the first pair that is not equal
+	//! O(n)
+	template <typename T>
+	inline size_t __simd_mismatch(const T* first1, const T* last1, const T* first2) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: return __mismatch_avx2(first1, last1, first2);
+		case simd_sse2: return __mismatch_sse2(first1, last1, first2);
+		}
+#endif
+		return __mismatch_scalar(first1, last1, first2);
+	}
+
+	//! O(n)
+	template <typename T>
+	inline size_t __simd_adjacent_find(const T* first, const T* last) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: return __adjacent_find_avx2(first, last);
+		case simd_sse2: return __adjacent_find_sse2(first, last);
+		}
+#endif
+		return __adjacent_find_scalar(first, last);
+	}
+	// the first smallest element, a NaN at first is the smallest as in the scalar loop
+	//! O(n)
+	template <typename T>
+	inline size_t __simd_min_element(const T* first, const T* last) {
+#ifdef __STL_SIMD
+		if (*first == *first) {
+			switch (simd_dispatch::level()) {
+			case simd_avx2: return __extreme_avx2<simd_less>(first, last);
+			case simd_sse2: return __extreme_sse2<simd_less>(first, last);
+			}
+		}
+#endif
+		return __extreme_scalar<simd_less>(first, last);
+	}
+
+	// the first largest element
+	//! O(n)
+	template <typename T>
+	inline size_t __simd_max_element(const T* first, const T* last) {
+#ifdef __STL_SIMD
+		if (*first == *first) {
+			switch (simd_dispatch::level()) {
+			case simd_avx2: return __extreme_avx2<simd_greater>(first, last);
+			case simd_sse2: return __extreme_sse2<simd_greater>(first, last);
+			}
+		}
+#endif
+		return __extreme_scalar<simd_greater>(first, last);
+	}
+
+	// the first smallest and the last largest integer
+	//! O(n)
+	template <typename T>
+	inline void __simd_minmax_element(const T* first, const T* last, size_t& min_offset, size_t& max_offset) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: __minmax_avx2(first, last, min_offset, max_offset); return;
+		case simd_sse2: __minmax_sse2(first, last, min_offset, max_offset); return;
+		}
+#endif
+		__minmax_scalar(first, last, min_offset, max_offset);
+	}
+
+	//! O(n)
+	template <int Arithmetic, typename T>
+	inline T __simd_accumulate(const T* first, const T* last, T init) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: return __accumulate_avx2<Arithmetic>(first, last, init);
+		case simd_sse2: return __accumulate_sse2<Arithmetic>(first, last, init);
+		}
+#endif
+		return __accumulate_scalar<Arithmetic>(first, last, init);
+	}
+
+	//! O(n)
+	template <typename T>
+	inline T __simd_inner_product(const T* first1, const T* last1, const T* first2, T init) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: return __inner_product_avx2(first1, last1, first2, init);
+		case simd_sse2: return __inner_product_sse2(first1, last1, first2, init);
+		}
+#endif
+		return __inner_product_scalar(first1, last1, first2, init);
+	}
+
+	//! O(n)
+	template <int Arithmetic, typename T>
+	inline void __simd_partial_sum(const T* first, const T* last, T* result) {
+#ifdef __STL_SIMD
+		switch (simd_dispatch::level()) {
+		case simd_avx2: __partial_sum_avx2<Arithmetic>(first, last, result); return;
+		case simd_sse2: __partial_sum_sse2<Arithmetic>(first, last, result); return;
+		}
+#endif
+		__partial_sum_scalar<Arithmetic>(first, last, result, __simd_identity<Arithmetic, T>());
+	}
+}
+
+#endif // !_SIMD_H_
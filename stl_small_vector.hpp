@@ -0,0 +1,251 @@
+#ifndef _SMALL_VECTOR_H_
+#define _SMALL_VECTOR_H_
+
+#include <cstring>
+
+#include "stl_vector.hpp"
+
+namespace selfmadeSTL {
+
+	// the inline space of a small_vector
+	template <typename T, size_t N>
+	struct __small_buffer {
+		alignas(T) unsigned char data[N * sizeof(T)];
+		// the vector space is the inline space
+		bool in_use;
+
+		__small_buffer() : in_use(false) {}
+	};
+
+	// gives the inline space to a request that fits in it while it is free,
+	// any other request goes to Alloc
+	// the allocator points into its small_vector, so it is never taken along
+	template <typename T, size_t N, typename Alloc>
+	class __small_buffer_allocator {
+	private:
+		__small_buffer<T, N>* buffer;
+
+		bool fits(size_t n) const { return n <= sizeof(buffer->data); }
+
+	public:
+		__small_buffer_allocator(__small_buffer<T, N>* b) : buffer(b) {}
+
+		void* allocate(size_t n) const {
+			if (fits(n) && !buffer->in_use) {
+				buffer->in_use = true;
+				return buffer->data;
+			}
+			return Alloc::allocate(n);
+		}
+		void deallocate(void* ptr, size_t n) const {
+			if (ptr == buffer->data)
+				buffer->in_use = false;
+			else
+				Alloc::deallocate(ptr, n);
+		}
+		// only for trivially relocatable elements, the bytes are moved
+		void* reallocate(void* ptr, size_t old_size, size_t new_size) const {
+			if (ptr == buffer->data) {
+				if (fits(new_size))
+					return ptr;
+				void* space = Alloc::allocate(new_size);
+				memcpy(space, ptr, old_size);
+				buffer->in_use = false;
+				return space;
+			}
+			if (fits(new_size) && !buffer->in_use) {
+				memcpy(buffer->data, ptr, new_size);
+				Alloc::deallocate(ptr, old_size);
+				buffer->in_use = true;
+				return buffer->data;
+			}
+			return Alloc::reallocate(ptr, old_size, new_size);
+		}
+
+		bool operator==(const __small_buffer_allocator& other) const { return buffer == other.buffer; }
+		bool operator!=(const __small_buffer_allocator& other) const { return buffer != other.buffer; }
+	};
+
+	// a vector that keeps up to N elements in itself, a larger one goes to the heap
+	// the storage logic is the one of vector, only the space of N elements comes from inside
+	template <typename T, size_t N, typename Alloc = alloc, typename Growth = growth_double>
+	class small_vector : private __small_buffer<T, N>,
+		private vector<T, __small_buffer_allocator<T, N, Alloc>, Growth> {
+		static_assert(N > 0, "small_vector needs an inline space");
+
+	private:
+		typedef __small_buffer<T, N> buffer_type;
+		typedef __small_buffer_allocator<T, N, Alloc> allocator_type;
+		typedef vector<T, allocator_type, Growth> base;
+		typedef typename base::vector_allocator vector_allocator;
+
+	public:
+		// ----- typedef -----
+
+		typedef typename base::value_type       value_type;
+		typedef typename base::pointer          pointer;
+		typedef typename base::iterator         iterator;
+		typedef typename base::reference        reference;
+		typedef typename base::size_type        size_type;
+		typedef typename base::difference_type  difference_type;
+		typedef typename base::const_pointer    const_pointer;
+		typedef typename base::const_iterator   const_iterator;
+		typedef typename base::const_reference  const_reference;
+		typedef Growth                          growth_policy;
+
+		static constexpr size_type inline_capacity = N;
+
+	private:
+		// an empty vector on the inline space
+		void reset_inline() {
+			this->start = vector_allocator::allocate(this->get_alloc(), N);
+			this->finish = this->start;
+			this->end_of_storage = this->start + N;
+		}
+
+		bool on_heap() const {
+			return static_cast<const void*>(this->start) != static_cast<const void*>(this->data);
+		}
+
+		// take the heap space of other, which is left on its inline space
+		void steal(small_vector& other) {
+			this->start = other.start;
+			this->finish = other.finish;
+			this->end_of_storage = other.end_of_storage;
+			other.reset_inline();
+		}
+
+	public:
+		// ----- basic constructor, destructor -----
+
+		small_vector() : buffer_type(), base(allocator_type(static_cast<buffer_type*>(this))) {
+			reset_inline();
+		}
+
+		small_vector(size_type n, const T& value) : small_vector() {
+			base::insert(end(), n, value);
+		}
+
+		explicit small_vector(size_type n) : small_vector() {
+			base::insert(end(), n, value_type());
+		}
+
+		small_vector(const value_type* first, const value_type* last) : small_vector() {
+			base::insert(end(), first, last);
+		}
+
+		small_vector(const small_vector& other) : small_vector() {
+			base::insert(end(), other.begin(), other.end());
+		}
+
+		// the heap space is taken, the inline elements are moved one by one
+		small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+			: buffer_type(), base(allocator_type(static_cast<buffer_type*>(this))) {
+			if (other.on_heap()) {
+				steal(other);
+			}
+			else {
+				reset_inline();
+				this->finish = selfmadeSTL::uninitialized_move(other.begin(), other.end(), this->start);
+				other.clear();
+			}
+		}
+
+		small_vector& operator=(const small_vector& other) {
+			if (this != &other) {
+				clear();
+				base::insert(end(), other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		small_vector& operator=(small_vector&& other) {
+			if (this != &other) {
+				clear();
+				if (other.on_heap()) {
+					vector_allocator::deallocate(this->get_alloc(), this->start, capacity());
+					steal(other);
+				}
+				else {
+					reserve(other.size());
+					this->finish = selfmadeSTL::uninitialized_move(other.begin(), other.end(), this->start);
+					other.clear();
+				}
+			}
+			return *this;
+		}
+
+		// ~vector() gives the space back, the inline space is only marked free
+
+		// ----- vector interface -----
+
+		using base::begin;
+		using base::end;
+		using base::cbegin;
+		using base::cend;
+		using base::size;
+		using base::capacity;
+		using base::empty;
+		using base::front;
+		using base::back;
+		using base::operator[];
+		using base::emplace_back;
+		using base::push_back;
+		using base::pop_back;
+		using base::emplace;
+		using base::insert;
+		using base::erase;
+		using base::clear;
+		using base::resize;
+		using base::resize_for_overwrite;
+		using base::append;
+		using base::reserve;
+
+		// the elements are in the inline space
+		bool is_inline() const { return !on_heap(); }
+
+		// back to the inline space if the elements fit in it
+		void shrink_to_fit() {
+			if (!on_heap()) {
+				return;
+			}
+			if (size() > N) {
+				base::shrink_to_fit();
+				return;
+			}
+			pointer space = vector_allocator::allocate(this->get_alloc(), N);
+			pointer new_finish = space;
+			try {
+				new_finish = selfmadeSTL::uninitialized_move_if_noexcept(begin(), end(), space);
+			}
+			catch (const std::exception&) {
+				vector_allocator::deallocate(this->get_alloc(), space, N);
+				throw;
+			}
+			this->replace_storage(space, new_finish, N);
+		}
+
+		// a heap space is swapped, inline elements are moved
+		void swap(small_vector& other) {
+			small_vector temp(std::move(other));
+			other = std::move(*this);
+			*this = std::move(temp);
+		}
+
+		// ----- operators override -----
+
+		bool operator==(const small_vector& other) const {
+			return size() == other.size() && selfmadeSTL::equal(begin(), end(), other.begin());
+		}
+
+		bool operator!=(const small_vector& other) const {
+			return !operator==(other);
+		}
+
+		bool operator<(const small_vector& other) const {
+			return selfmadeSTL::lexicographical_compare(begin(), end(), other.begin(), other.end());
+		}
+	};
+}
+
+#endif // !_SMALL_VECTOR_H_
@@ -1,6 +1,8 @@
 #ifndef _TYPE_TRAITS_H_
 #define _TYPE_TRAITS_H_
 
+#include <type_traits>
+
 namespace selfmadeSTL {
 	// non-trivial default ctor
 	// non-trivial copy ctor
@@ -12,18 +14,33 @@ namespace selfmadeSTL {
 	struct __true_type {};
 	struct __false_type {};
 
+	template <bool b>
+	struct __bool_type { typedef __false_type type; };
+	template <>
+	struct __bool_type<true> { typedef __true_type type; };
+
 	template <typename T>
 	struct __type_traits {
 		// if there are another class named __type_traits
 		// then the next line will tell the difference between them
 		typedef __true_type this_dummy_member_must_be_first;
 
-		// it will make specialized class for every data type
-		typedef __false_type	has_trivial_default_constructor;
-		typedef __false_type	has_trivial_copy_constructor;
-		typedef __false_type	has_trivial_assignment_operator;
-		typedef __false_type	has_trivial_destructor;
-		typedef __false_type	is_POD_type;
+		// the answers come from the compiler, so an aggregate of scalars
+		// takes the memmove paths without a specialization
+		// a move counts as a copy, so a user-provided move is not trivial
+		typedef typename __bool_type<std::is_trivially_default_constructible<T>::value>::type
+			has_trivial_default_constructor;
+		typedef typename __bool_type<std::is_trivially_copy_constructible<T>::value &&
+			std::is_trivially_move_constructible<T>::value>::type has_trivial_copy_constructor;
+		typedef typename __bool_type<std::is_trivially_copy_assignable<T>::value &&
+			std::is_trivially_move_assignable<T>::value>::type has_trivial_assignment_operator;
+		typedef typename __bool_type<std::is_trivially_destructible<T>::value>::type
+			has_trivial_destructor;
+		// made by memcpy and assigned by memmove in the raw memory
+		typedef typename __bool_type<std::is_trivially_copyable<T>::value &&
+			std::is_same<has_trivial_copy_constructor, __true_type>::value &&
+			std::is_same<has_trivial_assignment_operator, __true_type>::value &&
+			std::is_same<has_trivial_destructor, __true_type>::value>::type is_POD_type;
 	};
 
 	template <>
@@ -187,6 +204,16 @@ namespace selfmadeSTL {
 		typedef __true_type		has_trivial_destructor;
 		typedef __true_type		is_POD_type;
 	};
+
+	// an object can be moved to another address by copying its bytes,
+	// the old bytes are then forgotten without calling the destructor
+	// it is true for plain old data, a type opts in by a specialization:
+	//     template <> struct is_trivially_relocatable<my_type> { typedef __true_type type; };
+	// a type that keeps a pointer to itself (or to a member of itself) must not
+	template <typename T>
+	struct is_trivially_relocatable {
+		typedef typename __type_traits<T>::is_POD_type type;
+	};
 };
 
 #endif // !_TYPE_TRAITS_H_
\ No newline at end of file
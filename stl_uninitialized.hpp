@@ -1,6 +1,10 @@
 #ifndef _UNINITIALIZED_H_
 #define _UNINITIALIZED_H_
 
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
 #include "stl_algorithm.hpp"
 #include "stl_construct.hpp"
 #include "stl_type_traits.hpp"
@@ -20,11 +24,18 @@ namespace selfmadeSTL {
     template <typename InputIterator, typename ForwardIterator>
     ForwardIterator _uninitialized_copy_aux(InputIterator first, InputIterator last, ForwardIterator result, __false_type) {
         // if it is not a plain old data
-        // construct one by one
-        for (; first != last; ++first, ++result) {
-            construct(&*result, *first);
+        // construct one by one, destroy them all if one throws
+        ForwardIterator curr = result;
+        try {
+            for (; first != last; ++first, ++curr) {
+                construct(&*curr, *first);
+            }
+        }
+        catch (const std::exception&) {
+            destory(result, curr);
+            throw;
         }
-        return result;
+        return curr;
     }
 
     template <typename InputIterator, typename ForwardIterator, typename T>
@@ -39,6 +50,75 @@ namespace selfmadeSTL {
         return _uninitialized_copy(first, last, result, value_type(result));
     }
 
+    // uninitialized_move
+    // the same as uninitialized_copy, but the values are moved,
+    // the values left in [first, last) are moved from
+    // the constructed values are destroyed if one of them throws
+
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator _uninitialized_move_aux(InputIterator first, InputIterator last, ForwardIterator result, __true_type) {
+        return selfmadeSTL::copy(first, last, result);
+    }
+
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator _uninitialized_move_aux(InputIterator first, InputIterator last, ForwardIterator result, __false_type) {
+        ForwardIterator curr = result;
+        try {
+            for (; first != last; ++first, ++curr) {
+                construct(&*curr, std::move(*first));
+            }
+        }
+        catch (const std::exception&) {
+            destory(result, curr);
+            throw;
+        }
+        return curr;
+    }
+
+    template <typename InputIterator, typename ForwardIterator, typename T>
+    ForwardIterator _uninitialized_move(InputIterator first, InputIterator last, ForwardIterator result, T*) {
+        typedef typename __type_traits<T>::is_POD_type is_POD;
+        return _uninitialized_move_aux(first, last, result, is_POD());
+    }
+
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator uninitialized_move(InputIterator first, InputIterator last, ForwardIterator result) {
+        return _uninitialized_move(first, last, result, value_type(result));
+    }
+
+    // move if the move constructor does not throw (or there is no copy constructor),
+    // otherwise copy, so that [first, last) is untouched if an exception is thrown
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator _uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator result, __true_type) {
+        return selfmadeSTL::uninitialized_move(first, last, result);
+    }
+
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator _uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator result, __false_type) {
+        return selfmadeSTL::uninitialized_copy(first, last, result);
+    }
+
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator result) {
+        typedef typename iterator_traits<InputIterator>::value_type T;
+        typedef typename std::conditional<
+            std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value,
+            __true_type, __false_type>::type move_safe;
+        return _uninitialized_move_if_noexcept(first, last, result, move_safe());
+    }
+
+    // uninitialized_relocate
+    // move the objects of a trivially relocatable type by their bytes,
+    // the ranges may overlap, [first, last) is raw memory afterwards
+    template <typename T>
+    inline T* uninitialized_relocate(T* first, T* last, T* result) {
+        const size_t n = last - first;
+        if (n != 0) {
+            memmove(static_cast<void*>(result), static_cast<const void*>(first), sizeof(T) * n);
+        }
+        return result + n;
+    }
+
     // uninitialized_fill
     // almost the same as uninitialized_copy
     template <typename ForwardIterator, typename T>
@@ -48,8 +128,15 @@ namespace selfmadeSTL {
 
     template <typename ForwardIterator, typename T>
     inline void _uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T& value, __false_type) {
-        for (; first != last; ++first) {
-            construct(&*first, value);
+        ForwardIterator curr = first;
+        try {
+            for (; curr != last; ++curr) {
+                construct(&*curr, value);
+            }
+        }
+        catch (const std::exception&) {
+            destory(first, curr);
+            throw;
         }
     }
 
@@ -72,9 +159,16 @@ namespace selfmadeSTL {
 
     template<typename ForwardIterator, typename size, typename T>
     ForwardIterator _uninitialized_fill_n_aux(ForwardIterator first, size n, const T& value, __false_type) {
-        for (; n > 0; --n, ++first)
-            construct(&*first, value);
-        return first;
+        ForwardIterator curr = first;
+        try {
+            for (; n > 0; --n, ++curr)
+                construct(&*curr, value);
+        }
+        catch (const std::exception&) {
+            destory(first, curr);
+            throw;
+        }
+        return curr;
     }
 
     template<typename ForwardIterator, typename size, typename T, typename I>
@@ -87,6 +181,37 @@ namespace selfmadeSTL {
 	ForwardIterator uninitialized_fill_n(ForwardIterator first, size n, const T& value)  {
 		return _uninitialized_fill_n(first, n, value, value_type(first));
 	}
+
+    // uninitialized_default_construct_n
+    // default initialization, the bytes of a trivial type are left as they are,
+    // so the space is not written before it is overwritten
+    template<typename ForwardIterator, typename size>
+    ForwardIterator _uninitialized_default_construct_n_aux(ForwardIterator first, size n, __true_type) {
+        selfmadeSTL::advance(first, n);
+        return first;
+    }
+
+    template<typename ForwardIterator, typename size>
+    ForwardIterator _uninitialized_default_construct_n_aux(ForwardIterator first, size n, __false_type) {
+        typedef typename iterator_traits<ForwardIterator>::value_type T;
+        ForwardIterator curr = first;
+        try {
+            for (; n > 0; --n, ++curr)
+                new(static_cast<void*>(&*curr)) T;
+        }
+        catch (const std::exception&) {
+            destory(first, curr);
+            throw;
+        }
+        return curr;
+    }
+
+    template<typename ForwardIterator, typename size>
+    ForwardIterator uninitialized_default_construct_n(ForwardIterator first, size n) {
+        typedef typename iterator_traits<ForwardIterator>::value_type T;
+        typedef typename __type_traits<T>::has_trivial_default_constructor trivial;
+        return _uninitialized_default_construct_n_aux(first, n, trivial());
+    }
 }
 
 #endif // !_UNINITIALIZED_H_
\ No newline at end of file
@@ -3,110 +3,315 @@
 
 #include "stl_algorithm.hpp"
 #include "stl_allocator.hpp"
+#include "stl_debug.hpp"
 #include "stl_iterator.hpp"
 #include "stl_type_traits.hpp"
 #include "stl_uninitialized.hpp"
 
 namespace selfmadeSTL {
-    
-    template <typename T, typename Alloc = allocator<T>>
-    class vector {
+
+    // growth policy of vector
+    // next_capacity() gives the new capacity when the space is full,
+    // it is at least required, and grows geometrically from old_capacity
+    // so that a sequence of appends (one by one or in bulk) is amortized O(1)
+
+    // capacity * Num / Den, Num / Den > 1
+    template <size_t Num, size_t Den>
+    struct geometric_growth {
+        static size_t next_capacity(size_t old_capacity, size_t required, size_t) {
+            size_t grown = old_capacity / Den * Num + old_capacity % Den * Num / Den;
+            if (grown <= old_capacity) {
+                grown = old_capacity + 1;
+            }
+            return grown < required ? required : grown;
+        }
+    };
+
+    typedef geometric_growth<2, 1> growth_double;
+    // the sum of the freed blocks can be reused by a later growth
+    typedef geometric_growth<3, 2> growth_half;
+
+    // the space of Base rounded up to whole pages once it is larger than a page
+    template <typename Base = growth_double, size_t PageSize = 4096>
+    struct page_growth {
+        static size_t next_capacity(size_t old_capacity, size_t required, size_t elem_size) {
+            size_t n = Base::next_capacity(old_capacity, required, elem_size);
+            size_t bytes = n * elem_size;
+            if (bytes > PageSize) {
+                n = (bytes + PageSize - 1) / PageSize * PageSize / elem_size;
+            }
+            return n;
+        }
+    };
+
+    // Alloc may be a static allocator or an allocator instance kept by the vector
+    // Growth decides the capacity when the vector grows
+    template <typename T, typename Alloc = allocator<T>, typename Growth = growth_double>
+    class vector : protected __alloc_holder<Alloc> {
     public:
         // ----- typedef -----
 
         typedef T           value_type;
         typedef T*          pointer;
-        typedef T*          iterator;
         typedef T&          reference;
         typedef size_t      size_type;
         typedef ptrdiff_t   difference_type;
         typedef const T*    const_pointer;
-        typedef const T*    const_iterator;
         typedef const T&    const_reference;
+#ifdef __STL_DEBUG
+        typedef __checked_iterator<T*, vector>        iterator;
+        typedef __checked_iterator<const T*, vector>  const_iterator;
+#else
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+#endif
         typedef simple_alloc<T, Alloc> vector_allocator;
+        typedef Alloc       allocator_type;
+        typedef Growth      growth_policy;
 
     protected:
+        typedef __alloc_holder<Alloc> alloc_holder;
+
         // ----- member variable -----
 
         // start position of used
-        iterator start;
+        pointer start;
         // end position of used
-        iterator finish;
+        pointer finish;
         // end position of all space
-        iterator end_of_storage;
+        pointer end_of_storage;
+
+#ifdef __STL_DEBUG
+        typedef __debug_space<vector> debug_space;
+
+        // the iterators belong to it, made with the first iterator and given away with
+        // the elements, its generation changes with the memory of the elements
+        mutable debug_space* space = nullptr;
+
+        template <typename, typename> friend class __checked_iterator;
+
+        bool __dereferenceable(const_pointer p) const { return start <= p && p < finish; }
+
+        const debug_space* iterator_space() const {
+            if (space == nullptr) {
+                space = new debug_space(this);
+            }
+            return space;
+        }
+
+        iterator make_iterator(pointer p) { return iterator(p, iterator_space()); }
+        const_iterator make_iterator(const_pointer p) const { return const_iterator(p, iterator_space()); }
+
+        // the pointer of an iterator of this vector
+        pointer position_of(iterator it) const {
+            __STL_CHECK(it.container() == this, "iterator of another container");
+            __STL_CHECK(it.valid(), "invalidated iterator");
+            return it.base();
+        }
+
+        void invalidate_iterators() {
+            if (space != nullptr) {
+                ++space->generation;
+            }
+        }
+
+        // the elements of this and other are exchanged, their iterators go with them
+        void swap_iterators(vector& other) {
+            std::swap(space, other.space);
+            if (space != nullptr) {
+                space->owner = this;
+            }
+            if (other.space != nullptr) {
+                other.space->owner = &other;
+            }
+        }
+
+        void release_iterators() {
+            delete space;
+            space = nullptr;
+        }
+#else
+        iterator make_iterator(pointer p) { return p; }
+        const_iterator make_iterator(const_pointer p) const { return p; }
+        pointer position_of(iterator it) const { return it; }
+        void invalidate_iterators() {}
+        void swap_iterators(vector&) {}
+        void release_iterators() {}
+#endif
 
     protected:
-        void insert_aux(iterator pos, const T& value) {
+        // elements that can be moved by memcpy, the storage is resized by reallocate
+        // and the elements are shifted by memmove
+        typedef typename is_trivially_relocatable<T>::type relocatable;
+
+        // build a value from args at pos, pos != finish or no space left
+        template <typename... Args>
+        void insert_aux(pointer pos, Args&&... args) {
             // if there are some space left
             if (finish != end_of_storage) {
-                // copy the value in finish - 1 to finish
-                construct(finish, *(finish - 1));
-                ++finish;
-                // copy the value in [pos, finish - 1) to [pos + 1, finish)
-                copy_backward(pos, finish - 2, finish - 1);
-                // place the inserted value
-                *pos = value;
+                insert_aux_in_space(pos, relocatable(), std::forward<Args>(args)...);
             }
             // if there is no space left
             else {
-                // allocate new space
-                const size_type old_capacity = capacity();
-                const size_type new_capacity = old_capacity != 0 ? 2 * old_capacity : 1;
-                iterator new_start = vector_allocator::allocate(new_capacity);
-                iterator new_finish = new_start;
-                try {
-                    // copy old [start, pos) to new [start, pos)
-                    new_finish = selfmadeSTL::uninitialized_copy(start, pos, new_start);
-                    // place the inserted value
-                    construct(new_finish, value);
-                    ++new_finish;
-                    // copy old [pos, finish) to new [pos + 1, finish)
-                    new_finish = selfmadeSTL::uninitialized_copy(pos, finish, new_finish);
-                }
-                catch (const std::exception&) {
-                    // exception handling
-                    destory(new_start, new_finish);
-                    vector_allocator::deallocate(new_start, new_capacity);
-                    throw;
-                }
-                // destroy and deallocation old space and assignment
-                destory(begin(), end());
-                vector_allocator::deallocate(start, old_capacity);
-                start = new_start;
-                finish = new_finish;
-                end_of_storage = new_start + new_capacity;
+                insert_aux_grow(pos, relocatable(), std::forward<Args>(args)...);
             }
         }
 
-        static void insert_aux(iterator pos) {
-            if (finish != end_of_storage) {
-                construct(finish, *(finish - 1));
+        // the capacity to grow to for required elements
+        size_type next_capacity(size_type required) const {
+            return Growth::next_capacity(capacity(), required, sizeof(T));
+        }
+
+        // space for n elements, it grows by the growth policy
+        void grow_for(size_type n) {
+            if (capacity() < n) {
+                reallocate_storage(next_capacity(n), relocatable());
+            }
+        }
+
+        // shift [pos, finish) by memmove, then build the value in the gap
+        template <typename... Args>
+        void insert_aux_in_space(pointer pos, __true_type, Args&&... args) {
+            // args may refer to an element that is moved
+            T value_copy(std::forward<Args>(args)...);
+            open_gap(pos, 1);
+            try {
+                construct(pos, std::move(value_copy));
+            }
+            catch (const std::exception&) {
+                close_gap(pos, 1);
+                throw;
+            }
+        }
+
+        template <typename... Args>
+        void insert_aux_in_space(pointer pos, __false_type, Args&&... args) {
+            // args may refer to an element that is moved
+            T value_copy(std::forward<Args>(args)...);
+            // move the value in finish - 1 to finish
+            construct(finish, std::move(*(finish - 1)));
+            ++finish;
+            // move the value in [pos, finish - 1) to [pos + 1, finish)
+            selfmadeSTL::move_backward(pos, finish - 2, finish - 1);
+            // place the inserted value
+            *pos = std::move(value_copy);
+        }
+
+        // for a relocatable T, move the bytes of [pos, finish) to [pos + n, finish + n)
+        // [pos, pos + n) is raw memory, there must be n free places
+        void open_gap(pointer pos, size_type n) {
+            finish = selfmadeSTL::uninitialized_relocate(pos, finish, pos + n);
+        }
+
+        // undo open_gap(pos, n), [pos, pos + n) is raw memory
+        void close_gap(pointer pos, size_type n) {
+            finish = selfmadeSTL::uninitialized_relocate(pos + n, finish, pos);
+        }
+
+        // grow with reallocate then insert in place
+        template <typename... Args>
+        void insert_aux_grow(pointer pos, __true_type, Args&&... args) {
+            // args may refer to the old space
+            T value_copy(std::forward<Args>(args)...);
+            const size_type n = pos - start;
+            reallocate_storage(next_capacity(size() + 1), __true_type());
+            pos = start + n;
+            if (pos == finish) {
+                construct(finish, std::move(value_copy));
                 ++finish;
-                copy_backward(pos, finish - 2, finish - 1);
-                *pos = value_type();
             }
             else {
-                const size_type old_capacity = capacity();
-                const size_type new_capacity = old_capacity != 0 ? 2 * old_capacity : 1;
-                iterator new_start = vector_allocator::allocate(new_capacity);
-                iterator new_finish = new_start;
-                try {
-                    new_finish = uninitialized_copy(start, pos, new_start);
-                    construct(new_finish);
-                    ++new_finish;
-                    new_finish = uninitialized_copy(pos, finish, new_finish);
-                }
-                catch (const std::exception&) {
-                    destory(new_start, new_finish);
-                    vector_allocator::deallocate(new_start, new_capacity);
-                    throw;
-                }
-                destory(begin(), end());
-                vector_allocator::deallocate(start, old_capacity);
-                start = new_start;
-                finish = new_finish;
-                end_of_storage = new_start + new_capacity;
+                insert_aux(pos, std::move(value_copy));
+            }
+        }
+
+        // grow with allocate, move (or copy) and deallocate
+        template <typename... Args>
+        void insert_aux_grow(pointer pos, __false_type, Args&&... args) {
+            // allocate new space
+            const size_type new_capacity = next_capacity(size() + 1);
+            pointer new_start = vector_allocator::allocate(this->get_alloc(), new_capacity);
+            pointer new_pos = new_start + (pos - start);
+            try {
+                // place the inserted value first, args may refer to the old space
+                construct(new_pos, std::forward<Args>(args)...);
+            }
+            catch (const std::exception&) {
+                vector_allocator::deallocate(this->get_alloc(), new_start, new_capacity);
+                throw;
             }
+            pointer new_finish = relocate_around(pos, new_start, new_pos, 1, new_capacity);
+            replace_storage(new_start, new_finish, new_capacity);
+        }
+
+        // move (or copy) old [start, pos) to new [start, new_pos)
+        // and old [pos, finish) to new [new_pos + n, ...),
+        // the inserted [new_pos, new_pos + n) is already built
+        // the new space is given up if it throws
+        pointer relocate_around(pointer pos, pointer new_start, pointer new_pos, size_type n, size_type new_capacity) {
+            return relocate_around(pos, new_start, new_pos, n, new_capacity, relocatable());
+        }
+
+        // the bytes are copied, the old elements are left without destruction
+        pointer relocate_around(pointer pos, pointer new_start, pointer new_pos, size_type n, size_type, __true_type) {
+            selfmadeSTL::uninitialized_relocate(start, pos, new_start);
+            pointer new_finish = selfmadeSTL::uninitialized_relocate(pos, finish, new_pos + n);
+            // nothing to destroy in the old space
+            finish = start;
+            return new_finish;
+        }
+
+        pointer relocate_around(pointer pos, pointer new_start, pointer new_pos, size_type n, size_type new_capacity, __false_type) {
+            try {
+                selfmadeSTL::uninitialized_move_if_noexcept(start, pos, new_start);
+            }
+            catch (const std::exception&) {
+                destory(new_pos, new_pos + n);
+                vector_allocator::deallocate(this->get_alloc(), new_start, new_capacity);
+                throw;
+            }
+            try {
+                return selfmadeSTL::uninitialized_move_if_noexcept(pos, finish, new_pos + n);
+            }
+            catch (const std::exception&) {
+                destory(new_start, new_pos + n);
+                vector_allocator::deallocate(this->get_alloc(), new_start, new_capacity);
+                throw;
+            }
+        }
+
+        // destroy and deallocate the old space, then use the new one
+        void replace_storage(pointer new_start, pointer new_finish, size_type new_capacity) {
+            invalidate_iterators();
+            destory(start, finish);
+            vector_allocator::deallocate(this->get_alloc(), start, capacity());
+            start = new_start;
+            finish = new_finish;
+            end_of_storage = new_start + new_capacity;
+        }
+
+        // change capacity to new_capacity, new_capacity >= size()
+        // the bytes are moved by the allocator
+        void reallocate_storage(size_type new_capacity, __true_type) {
+            invalidate_iterators();
+            const size_type old_size = size();
+            start = vector_allocator::reallocate(this->get_alloc(), start, capacity(), new_capacity);
+            finish = start + old_size;
+            end_of_storage = start + new_capacity;
+        }
+
+        // the elements are moved one by one, or copied if moving may throw
+        void reallocate_storage(size_type new_capacity, __false_type) {
+            pointer new_start = vector_allocator::allocate(this->get_alloc(), new_capacity);
+            pointer new_finish = new_start;
+            try {
+                new_finish = selfmadeSTL::uninitialized_move_if_noexcept(start, finish, new_start);
+            }
+            catch (const std::exception&) {
+                vector_allocator::deallocate(this->get_alloc(), new_start, new_capacity);
+                throw;
+            }
+            replace_storage(new_start, new_finish, new_capacity);
         }
 
     public:
@@ -115,26 +320,34 @@ namespace selfmadeSTL {
 
         explicit vector()
             : start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
+
+        explicit vector(const allocator_type& a)
+            : alloc_holder(a), start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
         
-        vector(size_type n, const T& value) {
-            start = vector_allocator::allocate(n);
+        vector(size_type n, const T& value, const allocator_type& a = allocator_type())
+            : alloc_holder(a) {
+            start = vector_allocator::allocate(this->get_alloc(), n);
             finish = selfmadeSTL::uninitialized_fill_n(start, n, value);
             end_of_storage = finish;
         }
         
-        explicit vector(const size_type n) {
-            start = vector_allocator::allocate(n);
+        explicit vector(const size_type n, const allocator_type& a = allocator_type())
+            : alloc_holder(a) {
+            start = vector_allocator::allocate(this->get_alloc(), n);
             finish = selfmadeSTL::uninitialized_fill_n(start, n, value_type());
             end_of_storage = finish;
         }
 
-        vector(const vector& other) {
-            start = vector_allocator::allocate(other.size());
-            finish = selfmadeSTL::uninitialized_copy(other.begin(), other.end(), begin());
+        vector(const vector& other)
+            : alloc_holder(other.get_alloc()) {
+            start = vector_allocator::allocate(this->get_alloc(), other.size());
+            finish = selfmadeSTL::uninitialized_copy(other.start, other.finish, start);
             end_of_storage = finish;
         }
 
-        vector(const vector&& other) {
+        vector(vector&& other) noexcept
+            : alloc_holder(other.get_alloc()) {
+            swap_iterators(other);
             start = other.start;
             finish = other.finish;
             end_of_storage = other.end_of_storage;
@@ -143,286 +356,408 @@ namespace selfmadeSTL {
             other.end_of_storage = nullptr;
         }
 
-        vector(const value_type* first, const value_type* last) {
-            start = vector_allocator::allocate(last - first);
-            finish = selfmadeSTL::uninitialized_copy(first, last, begin());
+        vector(const value_type* first, const value_type* last, const allocator_type& a = allocator_type())
+            : alloc_holder(a) {
+            start = vector_allocator::allocate(this->get_alloc(), last - first);
+            finish = selfmadeSTL::uninitialized_copy(first, last, start);
             end_of_storage = finish;
         }
 
-        vector(const iterator first, const iterator last) {
-            start = vector_allocator::allocate(last - first);
-            finish = selfmadeSTL::uninitialized_copy(first, last, begin());
+        vector(const iterator first, const iterator last, const allocator_type& a = allocator_type())
+            : alloc_holder(a) {
+            start = vector_allocator::allocate(this->get_alloc(), last - first);
+            finish = selfmadeSTL::uninitialized_copy(first, last, start);
             end_of_storage = finish;
         }
         
         vector& operator=(const vector& other) {
             if (this != &other) {
+                invalidate_iterators();
                 destory(start, finish);
-                vector_allocator::deallocate(start, capacity());
-                start = vector_allocator::allocate(other.size());
-                finish = selfmadeSTL::uninitialized_copy(other.begin(), other.end(), begin());
+                vector_allocator::deallocate(this->get_alloc(), start, capacity());
+                this->copy_assign_alloc(other);
+                start = vector_allocator::allocate(this->get_alloc(), other.size());
+                finish = selfmadeSTL::uninitialized_copy(other.start, other.finish, start);
                 end_of_storage = finish;
             }
             return *this;
         }
 
+        vector& operator=(vector&& other) noexcept(std::is_empty<Alloc>::value ||
+            std::is_same<typename __alloc_traits<Alloc>::propagate_on_container_move_assignment, __true_type>::value) {
+            if (this != &other) {
+                invalidate_iterators();
+                destory(start, finish);
+                // take the space of other, its iterators come along
+                // and the invalidated ones of this go to other
+                if (this->move_assign_takes_space(other)) {
+                    swap_iterators(other);
+                    vector_allocator::deallocate(this->get_alloc(), start, capacity());
+                    this->move_assign_alloc(other);
+                    start = other.start;
+                    finish = other.finish;
+                    end_of_storage = other.end_of_storage;
+                    other.start = nullptr;
+                    other.finish = nullptr;
+                    other.end_of_storage = nullptr;
+                }
+                // the allocators differ and stay, move the elements one by one
+                else {
+                    other.invalidate_iterators();
+                    finish = start;
+                    reserve(other.size());
+                    finish = selfmadeSTL::uninitialized_move(other.start, other.finish, start);
+                    other.clear();
+                }
+            }
+            return *this;
+        }
+
         ~vector() {
+            release_iterators();
             destory(start, finish);
-            vector_allocator::deallocate(start, capacity());
+            vector_allocator::deallocate(this->get_alloc(), start, capacity());
             start = nullptr;
             finish = nullptr;
             end_of_storage = nullptr;
         }
 
+        allocator_type get_allocator() const { return this->get_alloc(); }
+
         // ----- iterator function -----
 
-        iterator begin() { return start; }
-        iterator end() { return finish; }
-        const_iterator begin() const { return start; }
-        const_iterator end() const { return finish; }
-        const_iterator cbegin() const { return start; }
-        const_iterator cend() const { return finish; }
+        iterator begin() { return make_iterator(start); }
+        iterator end() { return make_iterator(finish); }
+        const_iterator begin() const { return make_iterator(start); }
+        const_iterator end() const { return make_iterator(finish); }
+        const_iterator cbegin() const { return make_iterator(start); }
+        const_iterator cend() const { return make_iterator(finish); }
 
         // ----- function that related to container size/capacity -----
 
-        size_type size() const { return (size_type)(end() - begin()); }
-        size_type capacity() const { return (size_type)(end_of_storage - begin()); }
-        bool empty() const { return begin() == end(); }
+        size_type size() const { return (size_type)(finish - start); }
+        size_type capacity() const { return (size_type)(end_of_storage - start); }
+        bool empty() const { return start == finish; }
 
 
         // ----- funtion that access elements -----
 
-        reference front() { return *begin(); }
-        reference back() { return *(end() - 1); }
-        reference operator[](size_type idx) { return *(begin() + idx); }
-        const_reference front() const { return *begin(); }
-        const_reference back() const { return *(end() - 1); }
-        const_reference operator[](size_type idx) const { return *(begin() + idx); }
+        reference front() {
+            __STL_CHECK(!empty(), "front() of an empty vector");
+            return *start;
+        }
+        reference back() {
+            __STL_CHECK(!empty(), "back() of an empty vector");
+            return *(finish - 1);
+        }
+        reference operator[](size_type idx) {
+            __STL_CHECK(idx < size(), "vector index out of range");
+            return *(start + idx);
+        }
+        const_reference front() const {
+            __STL_CHECK(!empty(), "front() of an empty vector");
+            return *start;
+        }
+        const_reference back() const {
+            __STL_CHECK(!empty(), "back() of an empty vector");
+            return *(finish - 1);
+        }
+        const_reference operator[](size_type idx) const {
+            __STL_CHECK(idx < size(), "vector index out of range");
+            return *(start + idx);
+        }
 
         // ----- function that change element in vector -----
 
-        void push_back(const T& value) {
+        // build the value in place at the end
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
             if (finish != end_of_storage) {
-                construct(finish, value);
+                construct(finish, std::forward<Args>(args)...);
                 ++finish;
             }
             else {
-                insert_aux(end(), value);
+                insert_aux(finish, std::forward<Args>(args)...);
             }
         }
 
-        void push_back() {
-            if (finish != end_of_storage) {
-                construct(finish);
-                ++finish;
-            }
-            else {
-                insert_aux(end());
-            }
-        }
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+        void push_back() { emplace_back(); }
 
         void pop_back() {
+            __STL_CHECK(!empty(), "pop_back() of an empty vector");
             --finish;
             destory(finish);
         }
 
-        iterator insert(iterator pos, const T& value) {
-            size_type n = pos - begin();
+        // build the value in place at the front of pos
+        template <typename... Args>
+        iterator emplace(iterator position, Args&&... args) {
+            pointer pos = insert_position(position);
+            size_type n = pos - start;
             // insert at finish
-            if (finish != end_of_storage && pos == end()) {
-                construct(finish, value);
+            if (finish != end_of_storage && pos == finish) {
+                construct(finish, std::forward<Args>(args)...);
                 ++finish;
             }
             // insert at middle
             else {
-                insert_aux(pos, value);
+                insert_aux(pos, std::forward<Args>(args)...);
             }
-            return begin() + n;
+            return make_iterator(start + n);
         }
 
-        iterator insert(iterator pos) {
-            size_type n = pos - begin();
-            // insert at finish
-            if (finish != end_of_storage && pos == end()) {
-                construct(finish);
-                ++finish;
-            }
-            // insert at middle
-            else {
-                insert_aux(pos);
-            }
-            return begin() + n;
-        }
+        iterator insert(iterator pos, const T& value) { return emplace(pos, value); }
+        iterator insert(iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+        iterator insert(iterator pos) { return emplace(pos); }
 
-        void insert(iterator pos, size_type n, const T& value) {
+        void insert(iterator position, size_type n, const T& value) {
+            pointer pos = insert_position(position);
             if (n != 0) {
                 // enough space
                 if ((size_type)(end_of_storage - finish) >= n) {
-                    const size_type after_pos = finish - pos;
-                    iterator old_finish = finish;
-                    // more tail elements
-                    if (after_pos > n) {
-                        // copy [finish - n, finish) to [finish, finish + n)
-                        selfmadeSTL::uninitialized_copy(finish - n, finish, finish);
-                        finish += n;
-                        // copy [pos, finish - n) to [pos + n, finish)
-                        copy_backward(pos, old_finish - n, old_finish);
-                        // fill [pos, pos + n)
-                        selfmadeSTL::fill(pos, pos + n, value);
-                    }
-                    // more inserted value
-                    else {
-                        // fill [finish, pos + n)
-                        selfmadeSTL::uninitialized_fill_n(finish, n - after_pos, value);
-                        finish += n - after_pos;
-                        // copy [pos, finish) to [pos + n, finish + n)
-                        selfmadeSTL::uninitialized_copy(pos, old_finish, finish);
-                        finish += after_pos;
-                        // fill [pos, finish)
-                        selfmadeSTL::fill(pos, old_finish, value);
-                    }
+                    // value may be in the part that is moved
+                    const T value_copy = value;
+                    fill_in_space(pos, n, value_copy, relocatable());
                 }
                 // not enough space
                 else {
-                    // allocate space
-                    const size_type old_size = size();
-                    const size_type old_capacity = capacity();
-                    const size_type new_capacity = old_size + n;
-                    iterator new_start = vector_allocator::allocate(new_capacity);
-                    iterator new_finish = new_start;
-                    try {
-                        // copy old [start, pos) to new [start, pos)
-                        new_finish = selfmadeSTL::uninitialized_copy(start, pos, new_start);
-                        // place n inserted value
-                        new_finish = selfmadeSTL::uninitialized_fill_n(new_finish, n, value);
-                        // copy old [pos, finish) to new [pos + n, finish + n)
-                        new_finish = selfmadeSTL::uninitialized_copy(pos, finish, new_finish);
-                    }
-                    catch (const std::exception&) {
-                        // exception handling
-                        destory(new_start, new_finish);
-                        vector_allocator::deallocate(new_start, new_capacity);
-                        throw;
-                    }
-                    // destroy and deallocation old space and assignment
-                    destory(begin(), end());
-                    vector_allocator::deallocate(start, old_capacity);
-                    start = new_start;
-                    finish = new_finish;
-                    end_of_storage = new_start + new_capacity;
+                    fill_grow(pos, n, value);
                 }
             }
         }
 
         template <typename InputIterator>
-        void insert(iterator pos, InputIterator first, InputIterator last) {
+        void insert(iterator position, InputIterator first, InputIterator last) {
+            pointer pos = insert_position(position);
             size_type n = selfmadeSTL::distance(first, last);
             if (n != 0) {
                 if ((size_type)(end_of_storage - finish) >= n) {
-                    const size_type after_pos = finish - pos;
-                    iterator old_finish = finish;
-                    if (after_pos > n) {
-                        // copy [finish - n, finish) to [finish, finish + n)
-                        selfmadeSTL::uninitialized_copy(finish - n, finish, finish);
-                        finish += n;
-                        // copy [pos, finish - n) to [pos + n, finish)
-                        selfmadeSTL::copy_backward(pos, old_finish - n, old_finish);
-                        // copy [first, last) to [pos, pos + n)
-                        selfmadeSTL::copy(first, last, pos);
-                    }
-                    else {
-                        // copy [first + after_pos, last) to [finish, pos + n)
-                        selfmadeSTL::uninitialized_copy(first + after_pos, last, finish);
-                        finish += n - after_pos;
-                        // copy [pos, finish) to [pos + n, finish + n)
-                        selfmadeSTL::uninitialized_copy(pos, old_finish, finish);
-                        finish += after_pos;
-                        // copy [first, first + after_pos) to [pos, finish)
-                        selfmadeSTL::copy(first, first + after_pos, pos);
-                    }
+                    copy_in_space(pos, first, last, n, relocatable());
                 }
                 else {
-                    const size_type old_size = size();
-                    const size_type old_capacity = capacity();
-                    const size_type new_capacity = old_size + n;
-                    iterator new_start = vector_allocator::allocate(new_capacity);
-                    iterator new_finish = new_start;
-                    try {
-                        new_finish = selfmadeSTL::uninitialized_copy(start, pos, new_start);
-                        new_finish = selfmadeSTL::uninitialized_copy(first, last, new_finish);
-                        new_finish = selfmadeSTL::uninitialized_copy(pos, finish, new_finish);
-                    }
-                    catch (const std::exception&) {
-                        destory(new_start, new_finish);
-                        vector_allocator::deallocate(new_start, new_capacity);
-                        throw;
-                    }
-                    destory(begin(), end());
-                    vector_allocator::deallocate(start, old_capacity);
-                    start = new_start;
-                    finish = new_finish;
-                    end_of_storage = new_start + new_capacity;
+                    copy_grow(pos, first, last, n);
                 }
             }
         }
 
-        iterator erase(iterator pos) {
-            if (pos + 1 != end()) {
-                copy(pos + 1, finish, pos);
-            }
-            pop_back();
-            return pos;
+        iterator erase(iterator position) {
+            pointer pos = position_of(position);
+            __STL_CHECK(start <= pos && pos < finish, "erase() out of range");
+            erase_aux(pos, pos + 1, relocatable());
+            return make_iterator(pos);
         }
         
         iterator erase(iterator first, iterator last) {
-            iterator new_finish = selfmadeSTL::copy(last, finish, first);
+            pointer p = position_of(first);
+            pointer q = position_of(last);
+            __STL_CHECK(start <= p && p <= q && q <= finish, "erase() out of range");
+            if (p != q) {
+                erase_aux(p, q, relocatable());
+            }
+            return make_iterator(p);
+        }
+
+    protected:
+        // the pointer of an iterator to insert at, in [start, finish]
+        pointer insert_position(iterator position) const {
+            pointer pos = position_of(position);
+            __STL_CHECK(start <= pos && pos <= finish, "insert() out of range");
+            return pos;
+        }
+
+        // n copies of value to [pos, pos + n), there are n free places
+        // the tail is moved by memmove, and moved back if it throws
+        void fill_in_space(pointer pos, size_type n, const T& value_copy, __true_type) {
+            open_gap(pos, n);
+            try {
+                selfmadeSTL::uninitialized_fill_n(pos, n, value_copy);
+            }
+            catch (const std::exception&) {
+                close_gap(pos, n);
+                throw;
+            }
+        }
+
+        void fill_in_space(pointer pos, size_type n, const T& value_copy, __false_type) {
+            const size_type after_pos = finish - pos;
+            pointer old_finish = finish;
+            // more tail elements
+            if (after_pos > n) {
+                // move [finish - n, finish) to [finish, finish + n)
+                selfmadeSTL::uninitialized_move(finish - n, finish, finish);
+                finish += n;
+                // move [pos, finish - n) to [pos + n, finish)
+                selfmadeSTL::move_backward(pos, old_finish - n, old_finish);
+                // fill [pos, pos + n)
+                selfmadeSTL::fill(pos, pos + n, value_copy);
+            }
+            // more inserted value
+            else {
+                // fill [finish, pos + n)
+                selfmadeSTL::uninitialized_fill_n(finish, n - after_pos, value_copy);
+                finish += n - after_pos;
+                // move [pos, finish) to [pos + n, finish + n)
+                selfmadeSTL::uninitialized_move(pos, old_finish, finish);
+                finish += after_pos;
+                // fill [pos, finish)
+                selfmadeSTL::fill(pos, old_finish, value_copy);
+            }
+        }
+
+        // n copies of value to [pos, pos + n) in a new space
+        void fill_grow(pointer pos, size_type n, const T& value) {
+            // allocate space
+            const size_type new_capacity = next_capacity(size() + n);
+            pointer new_start = vector_allocator::allocate(this->get_alloc(), new_capacity);
+            pointer new_pos = new_start + (pos - start);
+            try {
+                // place n inserted value first, it may be in the old space
+                selfmadeSTL::uninitialized_fill_n(new_pos, n, value);
+            }
+            catch (const std::exception&) {
+                vector_allocator::deallocate(this->get_alloc(), new_start, new_capacity);
+                throw;
+            }
+            // move old [start, pos) and [pos, finish) around them
+            pointer new_finish = relocate_around(pos, new_start, new_pos, n, new_capacity);
+            replace_storage(new_start, new_finish, new_capacity);
+        }
+
+        // copy [first, last) to [pos, pos + n), there are n free places
+        // [first, last) is not in this vector
+        template <typename InputIterator>
+        void copy_in_space(pointer pos, InputIterator first, InputIterator last, size_type n, __true_type) {
+            open_gap(pos, n);
+            try {
+                selfmadeSTL::uninitialized_copy(first, last, pos);
+            }
+            catch (const std::exception&) {
+                close_gap(pos, n);
+                throw;
+            }
+        }
+
+        template <typename InputIterator>
+        void copy_in_space(pointer pos, InputIterator first, InputIterator last, size_type n, __false_type) {
+            const size_type after_pos = finish - pos;
+            pointer old_finish = finish;
+            if (after_pos > n) {
+                // move [finish - n, finish) to [finish, finish + n)
+                selfmadeSTL::uninitialized_move(finish - n, finish, finish);
+                finish += n;
+                // move [pos, finish - n) to [pos + n, finish)
+                selfmadeSTL::move_backward(pos, old_finish - n, old_finish);
+                // copy [first, last) to [pos, pos + n)
+                selfmadeSTL::copy(first, last, pos);
+            }
+            else {
+                // copy [first + after_pos, last) to [finish, pos + n)
+                selfmadeSTL::uninitialized_copy(first + after_pos, last, finish);
+                finish += n - after_pos;
+                // move [pos, finish) to [pos + n, finish + n)
+                selfmadeSTL::uninitialized_move(pos, old_finish, finish);
+                finish += after_pos;
+                // copy [first, first + after_pos) to [pos, finish)
+                selfmadeSTL::copy(first, first + after_pos, pos);
+            }
+        }
+
+        template <typename InputIterator>
+        void copy_grow(pointer pos, InputIterator first, InputIterator last, size_type n) {
+            const size_type new_capacity = next_capacity(size() + n);
+            pointer new_start = vector_allocator::allocate(this->get_alloc(), new_capacity);
+            pointer new_pos = new_start + (pos - start);
+            try {
+                // [first, last) may be in the old space
+                selfmadeSTL::uninitialized_copy(first, last, new_pos);
+            }
+            catch (const std::exception&) {
+                vector_allocator::deallocate(this->get_alloc(), new_start, new_capacity);
+                throw;
+            }
+            pointer new_finish = relocate_around(pos, new_start, new_pos, n, new_capacity);
+            replace_storage(new_start, new_finish, new_capacity);
+        }
+
+        // destroy [first, last), then move the bytes of the tail to first
+        void erase_aux(pointer first, pointer last, __true_type) {
+            destory(first, last);
+            finish = selfmadeSTL::uninitialized_relocate(last, finish, first);
+        }
+
+        void erase_aux(pointer first, pointer last, __false_type) {
+            pointer new_finish = selfmadeSTL::move(last, finish, first);
             destory(new_finish, finish);
             finish = new_finish;
-            return first;
         }
 
+    public:
+
         void clear() {
-            erase(begin(), end());
+            erase_aux(start, finish, relocatable());
         }
 
         void resize(size_type new_size, const T& value = value_type()) {
             if (new_size < size()) {
-                erase(begin() + new_size, end());
+                erase_aux(start + new_size, finish, relocatable());
             }
             else {
                 insert(end(), new_size - size(), value);
             }
         }
 
+        // the new elements are default initialized, a trivial one is not written,
+        // for a space that is overwritten right after
+        void resize_for_overwrite(size_type new_size) {
+            if (new_size < size()) {
+                erase_aux(start + new_size, finish, relocatable());
+            }
+            else {
+                grow_for(new_size);
+                finish = selfmadeSTL::uninitialized_default_construct_n(finish, new_size - size());
+            }
+        }
+
+        // writer(first, count) writes at most count elements to [first, first + count)
+        // and returns how many it wrote, they are appended to the vector
+        // [first, first + count) are default initialized, so a trivial one is not written twice
+        template <typename Writer>
+        size_type append(size_type count, Writer writer) {
+            grow_for(size() + count);
+            pointer last = selfmadeSTL::uninitialized_default_construct_n(finish, count);
+            size_type written = 0;
+            try {
+                written = writer(finish, count);
+            }
+            catch (const std::exception&) {
+                destory(finish, last);
+                throw;
+            }
+            destory(finish + written, last);
+            finish += written;
+            return written;
+        }
+
         void reserve(size_type n) {
             if (capacity() < n) {
-                const size_type old_capacity = capacity();
-                iterator new_start = vector_allocator::allocate(n);
-                iterator new_finish = uninitialized_copy(begin(), end(), new_start);
-                destory(start, finish);
-                vector_allocator::deallocate(start, old_capacity);
-                start = new_start;
-                finish = new_finish;
-                end_of_storage = new_start + n;
+                reallocate_storage(n, relocatable());
             }
         }
 
         void shrink_to_fit() {
             if (size() != capacity()) {
-                iterator new_start = vector_allocator::allocate(size());
-                iterator new_finish = selfmadeSTL::uninitialized_copy(begin(), end(), new_start);
-                destory(start, finish);
-                vector_allocator::deallocate(start, capacity());
-                start = new_start;
-                finish = new_finish;
-                end_of_storage = new_finish;
+                reallocate_storage(size(), relocatable());
             }
         }
 
         void swap(vector& other) {
+            swap_iterators(other);
             std::swap(start, other.start);
             std::swap(finish, other.finish);
             std::swap(end_of_storage, other.end_of_storage);
+            this->swap_alloc(other);
         }
 
         // ----- operators override -----
@@ -440,6 +775,17 @@ namespace selfmadeSTL {
         }
 
     };
+
+    // the vector only keeps pointers to its space, but under __STL_DEBUG the
+    // space of its iterators points back at it and is moved by the constructor
+    template <typename T, typename Alloc, typename Growth>
+    struct is_trivially_relocatable<vector<T, Alloc, Growth>> {
+#ifdef __STL_DEBUG
+        typedef __false_type type;
+#else
+        typedef typename __alloc_traits<Alloc>::is_trivially_relocatable type;
+#endif
+    };
 }
 
 #endif // !_VECTOR_H_
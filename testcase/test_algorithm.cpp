@@ -1,5 +1,7 @@
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 
 #include "../stl_algorithm.hpp"
 #include "../stl_function.hpp"
@@ -213,6 +215,164 @@ int main() {
 	sort(v9.begin(), v9.end(), greater<int>());
 	cout << v9.front() << ' ' << v9.back() << endl;
 
+	cout << "radix_sort: ";
+	vector<long long> signed_keys;
+	vector<double> float_keys;
+	for (int i = 0; i < 5000; ++i) {
+		signed_keys.push_back((long long)(i * 7919 % 5000) - 2500);
+		float_keys.push_back(((i * 7919 % 5000) - 2500) * 0.25);
+	}
+	vector<long long> expected_keys = signed_keys;
+	__introsort_loop(expected_keys.begin(), expected_keys.end(), (long long*)0, 13);
+	radix_sort(signed_keys.begin(), signed_keys.end());
+	cout << (signed_keys == expected_keys) << ' ' << signed_keys.front() << ' ';
+	sort(float_keys.begin(), float_keys.end());
+	cout << float_keys.front() << ' ' << float_keys.back() << ' ';
+	sort(float_keys.begin(), float_keys.end(), greater<double>());
+	cout << float_keys.front() << ' ' << float_keys.back() << "[true -2500 -625 624.75 624.75 -625]" << endl;
+
+	cout << "radix_sort: ";
+	double special[] = { 1.5, -0.0, -1e300, 0.0, 3.0, -2.5, 1e-300, -1e-300 };
+	__msd_radix_sort(special, special + 8, __radix_value_key<double, false>(), 56);
+	for_each(special, special + 8, display<double>());
+	unsigned char bytes[] = { 200, 3, 255, 0, 17 };
+	radix_sort(bytes, bytes + 5);
+	cout << "|| " << (int)bytes[0] << ' ' << (int)bytes[4] << ' ';
+	// the in place MSD radix sort, used when there is no space for a buffer
+	vector<long long> msd_keys(expected_keys.begin(), expected_keys.end());
+	random_shuffle(msd_keys.begin(), msd_keys.end());
+	__msd_radix_sort(msd_keys.begin(), msd_keys.end(), __radix_value_key<long long, false>(), 56);
+	cout << (msd_keys == expected_keys) << "[-1e+300 -2.5 -1e-300 -0 0 1e-300 1.5 3 || 0 255 true]" << endl;
+
+	cout << "radix_sort: ";
+	vector<Record> records;
+	for (int i = 0; i < 2000; ++i) {
+		records.emplace_back(i, double(i % 10));
+	}
+	radix_sort(records.begin(), records.end(), [](const Record& r) { return -r.value; });
+	bool stable = true;
+	for (int i = 1; i < 2000; ++i) {
+		if (records[i].value == records[i - 1].value && records[i].id < records[i - 1].id)
+			stable = false;
+	}
+	// the records are moved round in place when there is no space to gather them
+	__radix_item<int> items[4] = { { 0, 2 }, { 0, 0 }, { 0, 3 }, { 0, 1 } };
+	int permuted[4] = { 10, 11, 12, 13 };
+	__radix_permute(permuted, items, 4);
+	cout << records.front().value << ' ' << records.front().id << ' ' << records.back().id << ' ' << stable << " || ";
+	for_each(permuted, permuted + 4, display<int>());
+	cout << "[9 9 1990 true || 12 10 13 11]" << endl;
+
+	cout << "sort patterns: ";
+	{
+		// comparisons per element, n log n is about 17 here
+		const int n = 100000;
+		size_t comparisons = 0;
+		auto counted_less = [&comparisons](int a, int b) { ++comparisons; return a < b; };
+		vector<int> sorted_keys(n), reversed_keys(n), few_keys(n);
+		for (int i = 0; i < n; ++i) {
+			sorted_keys[i] = i;
+			reversed_keys[i] = n - i;
+			few_keys[i] = i * 7919 % 4;
+		}
+		vector<int>* inputs[3] = { &sorted_keys, &reversed_keys, &few_keys };
+		for (int k = 0; k < 3; ++k) {
+			vector<int> keys = *inputs[k];
+			comparisons = 0;
+			sort(keys.begin(), keys.end(), counted_less);
+			bool ascending = true;
+			for (int i = 1; i < n; ++i) {
+				ascending = ascending && !(keys[i] < keys[i - 1]);
+			}
+			cout << ascending << ' ' << (comparisons < 4 * (size_t)n) << ' ';
+
+			keys = *inputs[k];
+			comparisons = 0;
+			nth_element(keys.begin(), keys.begin() + n / 3, keys.end(), counted_less);
+			vector<int> expected = *inputs[k];
+			sort(expected.begin(), expected.end());
+			cout << (keys[n / 3] == expected[n / 3]) << ' ' << (comparisons < 4 * (size_t)n) << " | ";
+		}
+		cout << "[true true true true | true true true true | true true true true | ]" << endl;
+	}
+
+	cout << "simd scans: ";
+	{
+		// the same answers at every level, the vector loops and their scalar tails
+		vector<int32_t> ints(1000);
+		vector<uint8_t> bytes(1000);
+		for (int i = 0; i < 1000; ++i) {
+			ints[i] = i - 500;
+			bytes[i] = uint8_t(i % 250);
+		}
+		vector<int32_t> other_ints = ints;
+		other_ints[997] = 0;
+		vector<uint8_t> other_bytes = bytes;
+		other_bytes[333] = 7;
+		int old_level = simd_dispatch::__set_level(simd_scalar);
+		for (int level = simd_scalar; level <= simd_dispatch::hardware_level(); ++level) {
+			simd_dispatch::__set_level(level);
+			cout << (find(ints.begin(), ints.end(), 498) - ints.begin()) << ' '
+				<< (find(bytes.begin(), bytes.end(), uint8_t(249)) - bytes.begin()) << ' '
+				<< count(bytes.begin(), bytes.end(), uint8_t(3)) << ' '
+				<< count_if(ints.begin(), ints.end(), bind2nd(less<int32_t>(), -100)) << ' '
+				<< count_if(bytes.begin(), bytes.end(), bind1st(less<uint8_t>(), uint8_t(200))) << ' '
+				<< (mismatch(ints.begin(), ints.end(), other_ints.begin()).first - ints.begin()) << ' '
+				<< (mismatch(bytes.begin(), bytes.end(), other_bytes.begin()).first - bytes.begin()) << ' '
+				<< equal(ints.begin(), ints.end(), ints.begin()) << ' '
+				<< (adjacent_find(bytes.begin(), bytes.end()) - bytes.begin()) << " | ";
+		}
+		simd_dispatch::__set_level(old_level);
+	}
+	cout << "[998 249 4 400 196 997 333 true 1000 | ...]" << endl;
+
+	cout << "simd extremes: ";
+	{
+		// repeated extremes give the first position, and the last maximum for minmax_element,
+		// a NaN after the first element is never the answer
+		vector<int32_t> ints(1000);
+		vector<uint8_t> bytes(1000);
+		vector<float> floats(1000);
+		for (int i = 0; i < 1000; ++i) {
+			ints[i] = (i * 37) % 1000 - 500;
+			bytes[i] = uint8_t(i % 250 + 3);
+			floats[i] = float(i % 100);
+		}
+		ints[700] = ints[850] = -600;
+		ints[20] = ints[960] = 900;
+		bytes[600] = bytes[601] = 1;
+		floats[5] = std::numeric_limits<float>::quiet_NaN();
+		floats[999] = -1;
+		vector<float> nan_first = floats;
+		nan_first[0] = std::numeric_limits<float>::quiet_NaN();
+		int old_level = simd_dispatch::__set_level(simd_scalar);
+		for (int level = simd_scalar; level <= simd_dispatch::hardware_level(); ++level) {
+			simd_dispatch::__set_level(level);
+			auto int_extremes = minmax_element(ints.begin(), ints.end());
+			auto byte_extremes = minmax_element(bytes.begin(), bytes.end());
+			cout << (min_element(ints.begin(), ints.end()) - ints.begin()) << ' '
+				<< (max_element(ints.begin(), ints.end()) - ints.begin()) << ' '
+				<< (int_extremes.first - ints.begin()) << ' ' << (int_extremes.second - ints.begin()) << ' '
+				<< (byte_extremes.first - bytes.begin()) << ' ' << (byte_extremes.second - bytes.begin()) << ' '
+				<< (min_element(floats.begin(), floats.end()) - floats.begin()) << ' '
+				<< (max_element(floats.begin(), floats.end()) - floats.begin()) << ' '
+				<< (min_element(nan_first.begin(), nan_first.end()) - nan_first.begin()) << " | ";
+		}
+		simd_dispatch::__set_level(old_level);
+	}
+	cout << "[700 20 700 960 600 999 999 99 0 | ...]" << endl;
+
+	cout << "minmax_element: ";
+	{
+		int values[] = { 5, 2, 9, 2, 7, 9, 4 };
+		auto both = minmax_element(values, values + 7, less<int>());
+		auto odd = minmax_element(values, values + 6, greater<int>());
+		cout << (both.first - values) << ' ' << (both.second - values) << ' '
+			<< (odd.first - values) << ' ' << (odd.second - values) << ' '
+			<< (minmax_element(values, values).first - values) << endl;
+	}
+	cout << "[1 5 2 3 0]" << endl;
+
 	v8.push_back(22);
 	v8.push_back(30);
 	v8.push_back(17);
@@ -264,6 +424,51 @@ int main() {
 	merge_sort(v9.begin(), v9.end(), greater<int>());
 	cout << v9.front() << ' ' << v9.back() << endl;
 
+	cout << "stable_sort: ";
+	{
+		// records without a default constructor, ten ids for each value
+		vector<Record> by_value;
+		for (int i = 0; i < 5000; ++i) {
+			by_value.emplace_back(i, double(i * 7 % 500));
+		}
+		auto value_less = [](const Record& a, const Record& b) { return a.value < b.value; };
+		auto in_order = [](const vector<Record>& r) {
+			for (size_t i = 1; i < r.size(); ++i) {
+				if (r[i].value < r[i - 1].value || (r[i].value == r[i - 1].value && r[i].id < r[i - 1].id))
+					return false;
+			}
+			return true;
+		};
+		vector<Record> stable = by_value;
+		stable_sort(stable.begin(), stable.end(), value_less);
+		// the rotation merge when no buffer can be got
+		vector<Record> bufferless = by_value;
+		__inplace_stable_sort(bufferless.begin(), bufferless.end(), value_less);
+		cout << in_order(stable) << ' ' << in_order(bufferless) << ' ' << stable.front().id << ' ' << stable.back().id << " || ";
+
+		// equal values of the first half stay before those of the second
+		vector<Record> halves;
+		for (int i = 0; i < 6; ++i) {
+			halves.emplace_back(i, double(i / 2));
+		}
+		for (int i = 6; i < 10; ++i) {
+			halves.emplace_back(i, double(i - 6));
+		}
+		inplace_merge(halves.begin(), halves.begin() + 6, halves.end(), value_less);
+		for (size_t i = 0; i < halves.size(); ++i) {
+			cout << halves[i].id << ' ';
+		}
+		cout << "|| ";
+
+		vector<int> ints(v9.begin(), v9.end());
+		random_shuffle(ints.begin(), ints.end());
+		stable_sort(ints.begin(), ints.end());
+		cout << ints.front() << ' ' << ints.back() << ' ';
+		stable_sort(ints.begin(), ints.end(), greater<int>());
+		cout << ints.front() << ' ' << ints.back();
+	}
+	cout << "[true true 0 4857 || 0 1 6 2 3 7 4 5 8 9 || 0 99999 99999 0]" << endl;
+
 	random_shuffle(v9.begin(), v9.end());
 	vector<int> v10 = v9;
 	// 15ms
@@ -272,13 +477,19 @@ int main() {
 	auto end = std::chrono::high_resolution_clock::now();
 	cout << "sort time: " << (double)std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms || " << v9.front() << ' ' << v9.back() << endl;
 
-	// it can be much faster if we use buffer: 550ms
+	// merges through a buffer since it can be got: 550ms without one
 	v9 = v10;
 	start = std::chrono::high_resolution_clock::now();
 	merge_sort(v9.begin(), v9.end());
 	end = std::chrono::high_resolution_clock::now();
 	cout << "merge sort time: " << (double)std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms || " << v9.front() << ' ' << v9.back() << endl;
 
+	v9 = v10;
+	start = std::chrono::high_resolution_clock::now();
+	stable_sort(v9.begin(), v9.end());
+	end = std::chrono::high_resolution_clock::now();
+	cout << "stable sort time: " << (double)std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms || " << v9.front() << ' ' << v9.back() << endl;
+
 	// 30ms
 	v9 = v10;
 	start = std::chrono::high_resolution_clock::now();
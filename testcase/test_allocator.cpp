@@ -1,8 +1,14 @@
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <list>
+#include <thread>
 
+#define __STL_ALLOC_STATS
 #include "../stl_allocator.hpp"
+#include "../stl_deque.hpp"
+#include "../stl_list.hpp"
+#include "../stl_vector.hpp"
 
 using namespace std;
 
@@ -28,4 +34,174 @@ int main() {
 	cout << A.max_size() << "[1073741823]\n";
 
 	cout << endl;
-}
\ No newline at end of file
+
+	// blocks allocated in one thread and freed in another
+	const size_t block_num = 10000;
+	int* blocks[block_num];
+	std::thread producer([&]() {
+		for (size_t i = 0; i < block_num; i++) {
+			blocks[i] = static_cast<int*>(selfmadeSTL::thread_alloc::allocate(sizeof(int) * (i % 32 + 1)));
+			blocks[i][0] = (int)i;
+		}
+	});
+	producer.join();
+	size_t broken = 0;
+	std::thread consumer([&]() {
+		for (size_t i = 0; i < block_num; i++) {
+			if (blocks[i][0] != (int)i)
+				broken++;
+			selfmadeSTL::thread_alloc::deallocate(blocks[i], sizeof(int) * (i % 32 + 1));
+		}
+	});
+	consumer.join();
+	for (size_t i = 0; i < block_num; i++) {
+		blocks[i] = static_cast<int*>(selfmadeSTL::thread_alloc::allocate(sizeof(int) * (i % 32 + 1)));
+	}
+	for (size_t i = 0; i < block_num; i++) {
+		selfmadeSTL::thread_alloc::deallocate(blocks[i], sizeof(int) * (i % 32 + 1));
+	}
+	cout << "cross thread: " << broken << "[0]\n";
+
+	// small block in the same free list, small to large, large to large
+	char* block = static_cast<char*>(selfmadeSTL::alloc::allocate(10));
+	block[0] = 'a';
+	char* same = static_cast<char*>(selfmadeSTL::alloc::reallocate(block, 10, 16));
+	cout << "reallocate in place: " << (same == block) << "[1]\n";
+	char* large = static_cast<char*>(selfmadeSTL::alloc::reallocate(same, 16, 1000));
+	large = static_cast<char*>(selfmadeSTL::alloc::reallocate(large, 1000, 100000));
+	cout << "reallocate: " << large[0] << "[a]\n";
+	selfmadeSTL::alloc::deallocate(large, 100000);
+	void* aligned = selfmadeSTL::malloc_alloc::allocate_aligned(1000, 64);
+	cout << "aligned: " << (reinterpret_cast<size_t>(aligned) % 64) << "[0]\n";
+	selfmadeSTL::malloc_alloc::deallocate_aligned(aligned, 1000, 64);
+
+	cout << endl;
+
+	// statistics of the memory pool, a separate instance
+	typedef selfmadeSTL::__default_alloc_template<false, 1> stats_alloc;
+	void* small[100];
+	for (size_t i = 0; i < 100; i++) {
+		small[i] = stats_alloc::allocate(24);
+	}
+	for (size_t i = 0; i < 50; i++) {
+		stats_alloc::deallocate(small[i], 24);
+	}
+	stats_alloc::pool_stats stats = stats_alloc::stats();
+	cout << "block size: " << stats.block_size[2] << "[24]\n";
+	cout << "allocate: " << stats.allocate_count[2] << "[100]\n";
+	cout << "deallocate: " << stats.deallocate_count[2] << "[50]\n";
+	cout << "free blocks: " << stats.free_blocks[2] << "[52]\n";
+	cout << "refill: " << stats.refill_count[2] << "[6]\n";
+	cout << "balanced: " << (stats.free_bytes + stats.used_bytes + stats.pool_bytes == stats.heap_size) << "[1]\n";
+	for (size_t i = 50; i < 100; i++) {
+		stats_alloc::deallocate(small[i], 24);
+	}
+
+	cout << endl;
+
+	// return idle chunks to the system
+	typedef selfmadeSTL::__default_alloc_template<false, 2> trim_alloc;
+	const size_t node_num = 100000;
+	void** nodes = new void*[node_num];
+	for (size_t i = 0; i < node_num; i++) {
+		nodes[i] = trim_alloc::allocate(32);
+	}
+	size_t peak = trim_alloc::stats().heap_size;
+	cout << "trim in use: " << trim_alloc::trim() << "[0]\n";
+	for (size_t i = 0; i < node_num; i++) {
+		trim_alloc::deallocate(nodes[i], 32);
+	}
+	cout << "trim: " << (trim_alloc::trim() == peak) << "[1]\n";
+	cout << "heap size: " << trim_alloc::stats().heap_size << "[0]\n";
+	trim_alloc::set_trim_threshold(1 << 20);
+	for (size_t i = 0; i < node_num; i++) {
+		nodes[i] = trim_alloc::allocate(32);
+	}
+	for (size_t i = 0; i < node_num; i++) {
+		trim_alloc::deallocate(nodes[i], 32);
+	}
+	cout << "threshold: " << (trim_alloc::stats().heap_size < peak) << "[1]\n";
+	delete[] nodes;
+
+	cout << endl;
+
+	// monotonic arena
+	typedef selfmadeSTL::arena_alloc arena;
+	int* first_int = static_cast<int*>(arena::allocate(sizeof(int)));
+	for (size_t i = 0; i < node_num; i++) {
+		int* p = static_cast<int*>(arena::allocate(sizeof(int) * (i % 8 + 1)));
+		p[i % 8] = (int)i;
+		arena::deallocate(p, sizeof(int) * (i % 8 + 1));
+	}
+	size_t arena_capacity = arena::capacity();
+	arena::reset();
+	cout << "arena reset: " << (arena::allocate(sizeof(int)) == first_int) << "[1]\n";
+	for (size_t i = 0; i < node_num; i++) {
+		arena::allocate(sizeof(int) * (i % 8 + 1));
+	}
+	cout << "arena reuse: " << (arena::capacity() == arena_capacity) << "[1]\n";
+	arena::release();
+	cout << "arena release: " << arena::capacity() << "[0]\n";
+
+	cout << endl;
+	// memory pool on huge page regions
+	typedef selfmadeSTL::__default_alloc_template<false, 3, selfmadeSTL::default_size_class,
+		selfmadeSTL::hugepage_backend> huge_alloc;
+	nodes = new void*[node_num];
+	for (size_t i = 0; i < node_num; i++) {
+		nodes[i] = huge_alloc::allocate(32);
+		memset(nodes[i], 0xff, 32);
+	}
+	cout << "huge page pool: " << (huge_alloc::stats().heap_size >= node_num * 32) << "[1]\n";
+	for (size_t i = 0; i < node_num; i++) {
+		huge_alloc::deallocate(nodes[i], 32);
+	}
+	huge_alloc::trim();
+	cout << "huge page trim: " << huge_alloc::stats().heap_size << "[0]\n";
+	void* huge_block = selfmadeSTL::hugepage_backend::allocate_aligned(4 << 20, 2 << 20);
+	cout << "huge page aligned: " << ((uintptr_t)huge_block % (2 << 20)) << "[0]\n";
+	selfmadeSTL::hugepage_backend::deallocate_aligned(huge_block, 4 << 20, 2 << 20);
+	delete[] nodes;
+
+	cout << endl;
+
+	// stateful allocator kept by containers
+	{
+		typedef selfmadeSTL::arena_allocator arena_allocator;
+		selfmadeSTL::arena arena1;
+		selfmadeSTL::arena arena2;
+		cout << "empty allocator: " << (sizeof(selfmadeSTL::vector<int>) == 3 * sizeof(int*)) << "[1]\n";
+		cout << "empty allocator: " << (sizeof(selfmadeSTL::list<int>) == sizeof(void*)) << "[1]\n";
+
+		selfmadeSTL::vector<int, arena_allocator> vec1((arena_allocator(arena1)));
+		for (int i = 0; i < 1000; i++) {
+			vec1.push_back(i);
+		}
+		selfmadeSTL::list<int, arena_allocator> list1(arr, arr + 5, arena_allocator(arena1));
+		list1.sort(greater<int>());
+		selfmadeSTL::deque<int, arena_allocator> deque1(100, 1, arena_allocator(arena1));
+		cout << "arena1: " << (arena1.capacity() != 0) << "[1]\n";
+		cout << "arena2: " << arena2.capacity() << "[0]\n";
+		cout << "list sort: " << list1.front() << ' ' << list1.back() << "[4 0]\n";
+		cout << "sort keeps allocator: " << (list1.get_allocator().resource() == &arena1) << "[1]\n";
+
+		// copy construction takes the allocator along, copy assignment does not
+		selfmadeSTL::vector<int, arena_allocator> vec2(vec1);
+		selfmadeSTL::vector<int, arena_allocator> vec3((arena_allocator(arena2)));
+		vec3 = vec1;
+		cout << "copy: " << (vec2.get_allocator() == vec1.get_allocator()) << "[1]\n";
+		cout << "copy assign: " << (vec3.get_allocator().resource() == &arena2) << ' ' << vec3[999] << "[1 999]\n";
+		selfmadeSTL::deque<int, arena_allocator> deque2((arena_allocator(arena2)));
+		deque2 = deque1;
+		cout << "copy assign: " << (deque2.get_allocator().resource() == &arena2) << ' ' << deque2.size() << "[1 100]\n";
+
+		// swap takes the allocators along
+		vec3.swap(vec1);
+		cout << "swap: " << (vec1.get_allocator().resource() == &arena2) << "[1]\n";
+		selfmadeSTL::list<int, arena_allocator> list2((arena_allocator(arena2)));
+		list2.swap(list1);
+		cout << "swap: " << (list2.get_allocator().resource() == &arena1) << ' ' << list2.size() << "[1 5]\n";
+	}
+
+	cout << endl;
+}
@@ -0,0 +1,132 @@
+#define __STL_DEBUG
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../stl_deque.hpp"
+#include "../stl_list.hpp"
+#include "../stl_vector.hpp"
+
+using std::cout;
+using std::endl;
+
+// a failed check throws, so that the misuse can be seen and the test goes on
+struct check_failure : std::logic_error {
+	check_failure(const char* message) : std::logic_error(message) {}
+};
+
+void throw_on_failure(const char* message, const char*, int) {
+	throw check_failure(message);
+}
+
+template <typename F>
+std::string failure_of(F f) {
+	try {
+		f();
+	}
+	catch (const check_failure& e) {
+		return e.what();
+	}
+	return "none";
+}
+
+int main() {
+	cout << std::boolalpha;
+	selfmadeSTL::debug_check::__set_check_handler(throw_on_failure);
+
+	{
+		cout << "----- Test of vector checks -----\n";
+		selfmadeSTL::vector<int> v(3, 1);
+		cout << "index: " << failure_of([&]() { v[3]; }) << "[vector index out of range]\n";
+		cout << "in range: " << failure_of([&]() { v[2]; }) << "[none]\n";
+
+		selfmadeSTL::vector<int> empty;
+		cout << "front: " << failure_of([&]() { empty.front(); }) << "[front() of an empty vector]\n";
+		cout << "back: " << failure_of([&]() { empty.back(); }) << "[back() of an empty vector]\n";
+		cout << "pop_back: " << failure_of([&]() { empty.pop_back(); }) << "[pop_back() of an empty vector]\n";
+		cout << "erase end: " << failure_of([&]() { v.erase(v.end()); }) << "[erase() out of range]\n";
+		cout << "other: " << failure_of([&]() { v.insert(empty.begin(), 1); }) << "[iterator of another container]\n";
+
+		selfmadeSTL::vector<int>::iterator it = v.begin();
+		cout << "deref: " << failure_of([&]() { *(it + 3); }) << "[iterator out of range]\n";
+		v.push_back(2);
+		cout << "after growth: " << failure_of([&]() { *it; }) << "[invalidated iterator]\n";
+		it = v.begin();
+		v.reserve(100);
+		cout << "after reserve: " << failure_of([&]() { v.erase(it); }) << "[invalidated iterator]\n";
+		it = v.begin();
+		v.push_back(3);
+		cout << "in capacity: " << failure_of([&]() { *it; }) << ' ' << v.size() << "[none 5]\n";
+		selfmadeSTL::vector<int>::const_iterator cit = v.begin();
+		it = v.begin();
+		v.swap(empty);
+		// the iterators go with the elements to the other vector
+		cout << "after swap: " << failure_of([&]() { *cit; }) << ' ' << *(cit + 4) << "[none 3]\n";
+		cout << "erase after swap: " << failure_of([&]() { empty.erase(it); }) << ' ' << empty.size() << "[none 4]\n";
+		cout << "swapped out: " << failure_of([&]() { v.erase(empty.begin()); }) << "[iterator of another container]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of vector iterators when the elements move -----\n";
+		selfmadeSTL::vector<int> v(3, 1);
+		selfmadeSTL::vector<int>::iterator it = v.begin() + 1;
+		selfmadeSTL::vector<int> moved(std::move(v));
+		cout << "after move: " << failure_of([&]() { *it = 2; }) << ' ' << moved[1] << "[none 2]\n";
+		cout << "insert after move: " << failure_of([&]() { moved.insert(it, 5); }) << ' ' << moved[1] << "[none 5]\n";
+
+		selfmadeSTL::vector<int> target(2, 7);
+		selfmadeSTL::vector<int>::iterator old = target.begin();
+		it = moved.begin();
+		target = std::move(moved);
+		cout << "after move assignment: " << failure_of([&]() { *it; }) << ' ' << *it << "[none 1]\n";
+		cout << "replaced: " << failure_of([&]() { *old; }) << "[invalidated iterator]\n";
+
+		// the outer vector moves the inner ones to a new space as it grows
+		selfmadeSTL::vector<selfmadeSTL::vector<int>> nested;
+		nested.push_back(selfmadeSTL::vector<int>(2, 9));
+		selfmadeSTL::vector<int>::iterator inner = nested[0].begin();
+		for (int i = 0; i < 100; ++i) {
+			nested.push_back(selfmadeSTL::vector<int>(1, i));
+		}
+		cout << "after outer growth: " << failure_of([&]() { *inner; }) << ' ' << *inner << "[none 9]\n";
+		nested.insert(nested.begin(), selfmadeSTL::vector<int>());
+		cout << "after outer insert: " << failure_of([&]() { *(inner + 1); }) << ' ' << nested[1].size() << "[none 2]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of deque checks -----\n";
+		selfmadeSTL::deque<int> d(3, 1);
+		cout << "index: " << failure_of([&]() { d[3]; }) << "[deque index out of range]\n";
+
+		selfmadeSTL::deque<int> empty;
+		cout << "front: " << failure_of([&]() { empty.front(); }) << "[front() of an empty deque]\n";
+		cout << "pop_front: " << failure_of([&]() { empty.pop_front(); }) << "[pop_front() of an empty deque]\n";
+		cout << "erase end: " << failure_of([&]() { d.erase(d.end()); }) << "[erase() of end()]\n";
+		cout << "other: " << failure_of([&]() { d.insert(empty.begin(), 2); }) << "[iterator of another container]\n";
+
+		selfmadeSTL::deque<int>::iterator it = d.begin();
+		d.push_front(0);
+		cout << "after push_front: " << failure_of([&]() { *it; }) << "[invalidated iterator]\n";
+		it = d.begin() + 1;
+		d.insert(d.begin() + 2, 5);
+		cout << "after insert: " << failure_of([&]() { d.erase(it); }) << "[invalidated iterator]\n";
+		it = d.begin();
+		d.pop_back();
+		cout << "after pop_back: " << failure_of([&]() { *it; }) << ' ' << d.size() << "[none 4]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of list checks -----\n";
+		selfmadeSTL::list<int> empty;
+		cout << "front: " << failure_of([&]() { empty.front(); }) << "[front() of an empty list]\n";
+		cout << "pop_back: " << failure_of([&]() { empty.pop_back(); }) << "[pop_back() of an empty list]\n";
+		cout << "erase end: " << failure_of([&]() { empty.erase(empty.end()); }) << "[erase() of end()]\n";
+	}
+	cout << endl;
+
+	return 0;
+}
@@ -271,5 +271,20 @@ int main() {
 			<< std_default_npod.back().ptr->imag() << "\n";
 	}
 
+	{
+		cout << "----- Test of emplace -----\n";
+		selfmadeSTL::deque<Record> records;
+		Record::reset();
+		for (int i = 0; i < 100; ++i) {
+			records.emplace_back(i + 100, 0.5);
+			records.emplace_front(99 - i, 0.5);
+		}
+		cout << "emplace_back, emplace_front: " << records.size() << ' ' << records.front().id << ' ' << records.back().id
+			<< ", copies = " << Record::copies << ", moves = " << Record::moves << "[200 0 199, 0, 0]\n";
+		records.emplace(records.begin() + 50, -1, 0.5);
+		cout << "emplace: " << records[50].id << ' ' << records[51].id << ", copies = " << Record::copies << "[-1 50, 0]\n";
+	}
+	cout << endl;
+
 	return 0;
 }
\ No newline at end of file
@@ -17,7 +17,7 @@ using namespace selfmadeSTL;
 template<typename InputIterator, typename UnaryOperator>
 UnaryOperator for_each_ptr(InputIterator first, InputIterator last, UnaryOperator op) {
     for (; first != last; ++first) {
-        op(first);
+        op(&*first);
     }
     return op;
 }
@@ -25,7 +25,7 @@ UnaryOperator for_each_ptr(InputIterator first, InputIterator last, UnaryOperato
 template<typename InputIterator, typename UnaryOperator>
 UnaryOperator for_each_ptr_2arg(InputIterator first, InputIterator last, const char* str, UnaryOperator op) {
     for (; first != last; ++first) {
-        op(first, str);
+        op(&*first, str);
     }
     return op;
 }
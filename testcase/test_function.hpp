@@ -18,8 +18,9 @@ public:
 		ptr->real(other.ptr->real());
 		ptr->imag(other.ptr->imag());
 	}
-	Npod(const Npod&& other) noexcept {
+	Npod(Npod&& other) noexcept {
 		ptr = other.ptr;
+		other.ptr = nullptr;
 	}
 	Npod(const double& real, const double& imag) {
 		ptr = new std::complex<double>();
@@ -28,11 +29,19 @@ public:
 	}
 	Npod& operator=(const Npod& other) {
 		if (this != &other) {
+			// moved from
+			if (ptr == nullptr) {
+				ptr = new std::complex<double>();
+			}
 			ptr->real(other.ptr->real());
 			ptr->imag(other.ptr->imag());
 		}
 		return *this;
 	}
+	Npod& operator=(Npod&& other) noexcept {
+		std::swap(ptr, other.ptr);
+		return *this;
+	}
 	~Npod() {
 		delete ptr;
 	}
@@ -62,6 +71,35 @@ public:
 	std::complex<double>* ptr;
 };
 
+// counts the copies and moves of all records, for in place construction
+class Record {
+public:
+	Record(int i, double d) : id(i), value(d) {}
+	Record(const Record& other) : id(other.id), value(other.value) { ++copies; }
+	Record(Record&& other) noexcept : id(other.id), value(other.value) { ++moves; }
+	Record& operator=(const Record& other) {
+		id = other.id;
+		value = other.value;
+		++copies;
+		return *this;
+	}
+	Record& operator=(Record&& other) noexcept {
+		id = other.id;
+		value = other.value;
+		++moves;
+		return *this;
+	}
+
+	static void reset() { copies = moves = 0; }
+
+	int id;
+	double value;
+	static int copies;
+	static int moves;
+};
+int Record::copies = 0;
+int Record::moves = 0;
+
 
 namespace selfmadeSTL {
 
@@ -4,6 +4,7 @@
 #include <complex>
 #include <random>
 #include <climits>
+#include <stdexcept>
 
 #include "../stl_list.hpp"
 #include "../stl_type_traits.hpp"
@@ -15,6 +16,28 @@ using std::default_random_engine;
 using std::uniform_real_distribution;
 using std::numeric_limits;
 
+// counts the values alive, so that a list that leaks its nodes shows it
+struct Tracked {
+	explicit Tracked(int v) : value(v) { ++live; }
+	Tracked(const Tracked& other) : value(other.value) { ++live; }
+	~Tracked() { --live; }
+
+	int value;
+	static int live;
+};
+int Tracked::live = 0;
+
+// throws at the limit-th comparison
+struct throwing_less {
+	int* calls;
+	int limit;
+	bool operator()(const Tracked& a, const Tracked& b) const {
+		if (++*calls == limit)
+			throw std::runtime_error("comparison failed");
+		return a.value < b.value;
+	}
+};
+
 int main() {
 	// initialize
 	const size_t pod_size = 100000;
@@ -327,5 +350,37 @@ int main() {
 	}
 	cout << '\n';
 
+	{
+		cout << "----- Test of emplace -----\n";
+		selfmadeSTL::list<Record> records;
+		Record::reset();
+		records.emplace_back(2, 2.5);
+		records.emplace_front(0, 0.5);
+		records.emplace(++records.begin(), 1, 1.5);
+		cout << "emplace: " << records.front().id << ' ' << (++records.begin())->id << ' ' << records.back().id
+			<< ", copies = " << Record::copies << ", moves = " << Record::moves << "[0 1 2, 0, 0]\n";
+	}
+	cout << '\n';
+
+	{
+		cout << "----- Test of sort when the comparison throws -----\n";
+		{
+			selfmadeSTL::list<Tracked> tracked;
+			for (int i = 0; i < 1000; ++i) {
+				tracked.push_back(Tracked(i * 7919 % 1000));
+			}
+			int calls = 0;
+			throwing_less comp = { &calls, 5000 };
+			try {
+				tracked.sort(comp);
+			}
+			catch (const std::exception&) {
+				cout << "thrown: " << calls << ' ';
+			}
+		}
+		cout << "alive after: " << Tracked::live << "[thrown: 5000 alive after: 0]\n";
+	}
+	cout << '\n';
+
 	return 0;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstdint>
 
 #include "../stl_function.hpp"
 #include "../stl_numeric.hpp"
@@ -50,5 +51,40 @@ int main() {
 	}
 	cout << endl;
 
+	cout << "simd numeric: ";
+	{
+		// the same answers at every level, floating point values that add up exactly in any order
+		vector<int> ints(1000);
+		vector<int> weights(1000);
+		vector<double> doubles(1000);
+		vector<float> floats(1000);
+		vector<double> factors(100);
+		for (int i = 0; i < 100; ++i) {
+			factors[i] = i % 4 == 3 ? 1.0 : (i % 4 == 1 ? 0.5 : 2.0);
+		}
+		for (int i = 0; i < 1000; ++i) {
+			ints[i] = i - 300;
+			weights[i] = i % 3;
+			doubles[i] = (i % 10) * 0.25;
+			floats[i] = float(i % 4) - 1.5f;
+		}
+		vector<int> int_sums(1000);
+		vector<double> double_sums(1000);
+		int old_level = simd_dispatch::__set_level(simd_scalar);
+		for (int level = simd_scalar; level <= simd_dispatch::hardware_level(); ++level) {
+			simd_dispatch::__set_level(level);
+			partial_sum(ints.begin(), ints.end(), int_sums.begin());
+			partial_sum(unseq, doubles.begin(), doubles.end(), double_sums.begin());
+			cout << accumulate(ints.begin(), ints.end(), 7) << ' '
+				<< accumulate(unseq, factors.begin(), factors.end(), 1.0, multiply<double>()) << ' '
+				<< inner_product(ints.begin(), ints.end(), weights.begin(), 0) << ' '
+				<< accumulate(unseq, doubles.begin(), doubles.end(), 0.0) << ' '
+				<< inner_product(unseq, floats.begin(), floats.end(), floats.begin(), 0.0f) << ' '
+				<< int_sums[999] << ' ' << int_sums[500] << ' ' << double_sums[999] << ' ' << double_sums[13] << " | ";
+		}
+		simd_dispatch::__set_level(old_level);
+	}
+	cout << "[199507 3.35544e+07 199467 1125 1250 199500 -25050 1125 12.75 | ...]" << endl;
+
 	return 0;
 }
\ No newline at end of file
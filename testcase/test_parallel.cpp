@@ -0,0 +1,192 @@
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#include "../stl_function.hpp"
+#include "../stl_parallel.hpp"
+#include "../stl_vector.hpp"
+
+using std::cout;
+using std::endl;
+using namespace selfmadeSTL;
+
+// a comparator that throws after limit comparisons
+struct throwing_less {
+	std::atomic<size_t>* count;
+	size_t limit;
+
+	bool operator()(int a, int b) const {
+		if (++*count > limit)
+			throw std::runtime_error("comparison");
+		return a < b;
+	}
+};
+
+bool ascending(const vector<int>& v) {
+	for (size_t i = 1; i < v.size(); ++i) {
+		if (v[i] < v[i - 1])
+			return false;
+	}
+	return true;
+}
+
+// an event of a log, sorted by key, the id tells the order it came in
+struct event {
+	int key;
+	int id;
+};
+
+struct key_less {
+	bool operator()(const event& a, const event& b) const { return a.key < b.key; }
+};
+
+bool same_events(const vector<event>& a, const vector<event>& b) {
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].key != b[i].key || a[i].id != b[i].id)
+			return false;
+	}
+	return true;
+}
+
+vector<event> random_events(std::mt19937& rng, size_t n, int keys) {
+	vector<event> events;
+	for (size_t i = 0; i < n; ++i) {
+		events.push_back(event{ int(rng() % keys), int(i) });
+	}
+	return events;
+}
+
+bool stable_as_sequential(vector<event> v, const parallel_policy& policy) {
+	vector<event> expected = v;
+	stable_sort(expected.begin(), expected.end(), key_less());
+	stable_sort(policy, v.begin(), v.end(), key_less());
+	return same_events(v, expected);
+}
+
+template <typename Compare>
+bool sorted_as_sequential(vector<int> v, const parallel_policy& policy, Compare comp) {
+	vector<int> expected = v;
+	sort(expected.begin(), expected.end(), comp);
+	sort(policy, v.begin(), v.end(), comp);
+	return v == expected;
+}
+
+int main() {
+	cout << std::boolalpha;
+
+	std::mt19937 rng(20);
+	vector<int> random_ints;
+	for (int i = 0; i < 1000000; ++i) {
+		random_ints.push_back((int)(rng() % 100000));
+	}
+
+	{
+		cout << "----- Test of parallel sort -----\n";
+		cout << "random: " << sorted_as_sequential(random_ints, parallel_policy(4), less<int>()) << "[true]\n";
+		cout << "greater: " << sorted_as_sequential(random_ints, parallel_policy(3), greater<int>()) << "[true]\n";
+		cout << "many threads: " << sorted_as_sequential(random_ints, parallel_policy(16), less<int>()) << "[true]\n";
+
+		vector<int> sorted = random_ints;
+		sort(sorted.begin(), sorted.end());
+		cout << "sorted: " << sorted_as_sequential(sorted, parallel_policy(4), less<int>()) << "[true]\n";
+		cout << "reversed: " << sorted_as_sequential(sorted, parallel_policy(4), greater<int>()) << "[true]\n";
+		cout << "equal: " << sorted_as_sequential(vector<int>(200000, 7), parallel_policy(4), less<int>()) << "[true]\n";
+
+		vector<int> small(random_ints.begin(), random_ints.begin() + 100);
+		sort(par, small.begin(), small.end());
+		cout << "small: " << ascending(small) << "[true]\n";
+
+		vector<int> default_threads = random_ints;
+		sort(par, default_threads.begin(), default_threads.end());
+		cout << "default threads: " << ascending(default_threads) << "[true]\n";
+
+		vector<int> sequenced = random_ints;
+		sort(seq, sequenced.begin(), sequenced.end(), greater<int>());
+		cout << "sequenced: " << sequenced.front() << ' ' << sequenced.back() << "[99999 0]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of parallel stable_sort -----\n";
+		vector<event> events = random_events(rng, 300000, 1000);
+		cout << "events: " << stable_as_sequential(events, parallel_policy(4)) << "[true]\n";
+		cout << "odd runs: " << stable_as_sequential(events, parallel_policy(3)) << "[true]\n";
+		cout << "few keys: " << stable_as_sequential(random_events(rng, 200000, 3), parallel_policy(8)) << "[true]\n";
+
+		vector<event> sorted = events;
+		stable_sort(sorted.begin(), sorted.end(), key_less());
+		cout << "sorted: " << stable_as_sequential(sorted, parallel_policy(4)) << "[true]\n";
+
+		vector<int> ints = random_ints;
+		stable_sort(par, ints.begin(), ints.end());
+		cout << "default threads: " << ascending(ints) << "[true]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of parallel merge -----\n";
+		vector<event> left = random_events(rng, 250000, 500);
+		vector<event> right = random_events(rng, 150000, 500);
+		for (size_t i = 0; i < right.size(); ++i) {
+			right[i].id += 1000000;
+		}
+		stable_sort(left.begin(), left.end(), key_less());
+		stable_sort(right.begin(), right.end(), key_less());
+
+		vector<event> expected(left.size() + right.size());
+		merge(left.begin(), left.end(), right.begin(), right.end(), expected.begin(), key_less());
+		vector<event> merged(left.size() + right.size());
+		vector<event>::iterator end = merge(parallel_policy(4), left.begin(), left.end(), right.begin(), right.end(),
+			merged.begin(), key_less());
+		cout << "events: " << same_events(merged, expected) << ' ' << (end == merged.end()) << "[true true]\n";
+
+		vector<event> reversed(left.size() + right.size());
+		merge(parallel_policy(4), right.begin(), right.end(), left.begin(), left.end(), reversed.begin(), key_less());
+		bool right_first = true;
+		for (size_t i = 1; i < reversed.size(); ++i) {
+			if (reversed[i].key == reversed[i - 1].key && reversed[i].id >= 1000000 && reversed[i - 1].id < 1000000)
+				right_first = false;
+		}
+		cout << "first input first: " << right_first << "[true]\n";
+
+		vector<int> odds, evens;
+		for (int i = 0; i < 100000; ++i) {
+			odds.push_back(2 * i + 1);
+			evens.push_back(2 * i);
+		}
+		vector<int> all(200000);
+		merge(par, odds.begin(), odds.end(), evens.begin(), evens.end(), all.begin());
+		cout << "ints: " << ascending(all) << ' ' << all.front() << ' ' << all.back() << "[true 0 199999]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of task exception -----\n";
+		vector<int> v = random_ints;
+		std::atomic<size_t> count(0);
+		bool thrown = false;
+		try {
+			sort(parallel_policy(4), v.begin(), v.end(), throwing_less{ &count, 5000000 });
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+		cout << "thrown: " << thrown << "[true]\n";
+
+		work_stealing_pool pool(4);
+		std::atomic<int> sum(0);
+		for (int i = 1; i <= 100; ++i) {
+			pool.submit([&pool, &sum, i]() {
+				pool.submit([&sum, i]() { sum += i; });
+			});
+		}
+		pool.run_until_done();
+		cout << "nested tasks: " << sum << "[5050]\n";
+	}
+	cout << endl;
+
+	return 0;
+}
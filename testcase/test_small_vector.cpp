@@ -0,0 +1,80 @@
+#include <iostream>
+#include <string>
+
+#include "../stl_small_vector.hpp"
+#include "test_function.hpp"
+
+using std::cout;
+using std::endl;
+
+int main() {
+	cout << std::boolalpha;
+
+	{
+		cout << "----- Test of inline space -----\n";
+		selfmadeSTL::small_vector<int, 8> small;
+		cout << "empty: " << small.size() << ' ' << small.capacity() << ' ' << small.is_inline() << "[0 8 true]\n";
+		for (int i = 0; i < 8; ++i) {
+			small.push_back(i);
+		}
+		cout << "full: " << small.size() << ' ' << small.back() << ' ' << small.is_inline() << "[8 7 true]\n";
+		small.push_back(8);
+		cout << "spill: " << small.size() << ' ' << small.capacity() << ' ' << small.is_inline() << "[9 16 false]\n";
+		small.insert(small.begin(), (size_t)20, -1);
+		small.erase(small.begin(), small.begin() + 24);
+		small.shrink_to_fit();
+		cout << "shrink: " << small.size() << ' ' << small.front() << ' ' << small.is_inline() << "[5 4 true]\n";
+
+		int arr[5] = { 0, 1, 2, 3, 4 };
+		selfmadeSTL::small_vector<int, 4> range(arr, arr + 5);
+		cout << "range: " << range.size() << ' ' << range[4] << ' ' << range.is_inline() << "[5 4 false]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of copy and move -----\n";
+		selfmadeSTL::small_vector<std::string, 2> inline_strings;
+		inline_strings.push_back("a");
+		inline_strings.emplace_back(3, 'b');
+		selfmadeSTL::small_vector<std::string, 2> heap_strings(inline_strings);
+		heap_strings.push_back("c");
+		cout << "copy: " << heap_strings[1] << ' ' << heap_strings.size() << ' ' << (heap_strings == inline_strings)
+			<< "[bbb 3 false]\n";
+
+		const std::string* heap_data = &heap_strings[0];
+		selfmadeSTL::small_vector<std::string, 2> moved_heap(std::move(heap_strings));
+		cout << "move heap: " << (&moved_heap[0] == heap_data) << ' ' << heap_strings.size() << ' '
+			<< heap_strings.is_inline() << "[true 0 true]\n";
+		selfmadeSTL::small_vector<std::string, 2> moved_inline(std::move(inline_strings));
+		cout << "move inline: " << moved_inline[1] << ' ' << moved_inline.is_inline() << ' ' << inline_strings.size()
+			<< "[bbb true 0]\n";
+
+		moved_inline = moved_heap;
+		cout << "copy assign: " << moved_inline.size() << ' ' << moved_inline.back() << "[3 c]\n";
+		moved_heap.swap(heap_strings);
+		cout << "swap: " << moved_heap.size() << ' ' << heap_strings.size() << ' ' << (&heap_strings[0] == heap_data)
+			<< "[0 3 true]\n";
+		heap_strings = std::move(moved_inline);
+		cout << "move assign: " << heap_strings.size() << ' ' << heap_strings[2] << ' ' << moved_inline.size() << "[3 c 0]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of elements -----\n";
+		Record::reset();
+		{
+			selfmadeSTL::small_vector<Record, 4> records;
+			for (int i = 0; i < 4; ++i) {
+				records.emplace_back(i, i + 0.5);
+			}
+			cout << "emplace_back: " << records[3].id << ", copies = " << Record::copies << ", moves = "
+				<< Record::moves << "[3, 0, 0]\n";
+			records.emplace(records.begin(), -1, -0.5);
+			cout << "spill moves: " << records.front().id << ' ' << records.size() << ", copies = " << Record::copies
+				<< "[-1 5, 0]\n";
+		}
+	}
+	cout << endl;
+
+	return 0;
+}
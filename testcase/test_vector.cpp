@@ -4,6 +4,7 @@
 #include <complex>
 #include <random>
 #include <climits>
+#include <string>
 
 #include "../stl_vector.hpp"
 #include "../stl_type_traits.hpp"
@@ -15,6 +16,40 @@ using std::default_random_engine;
 using std::uniform_real_distribution;
 using std::numeric_limits;
 
+// a record that opts in to relocation by memcpy
+struct Relocated {
+	Relocated(int i) : id(i), buffer(new int(i)) {}
+	Relocated(const Relocated& other) : id(other.id), buffer(new int(*other.buffer)) { ++copies; }
+	Relocated(Relocated&& other) noexcept : id(other.id), buffer(other.buffer) { other.buffer = nullptr; ++moves; }
+	Relocated& operator=(const Relocated& other) {
+		id = other.id;
+		*buffer = *other.buffer;
+		++copies;
+		return *this;
+	}
+	~Relocated() { delete buffer; }
+
+	int id;
+	int* buffer;
+	static int copies;
+	static int moves;
+};
+int Relocated::copies = 0;
+int Relocated::moves = 0;
+
+// an aggregate, plain old data without a specialization
+struct Point {
+	int x;
+	double y;
+};
+
+namespace selfmadeSTL {
+	template <>
+	struct is_trivially_relocatable<Relocated> {
+		typedef __true_type type;
+	};
+}
+
 int main(int argc, char* argv[]) {
 	// initialize
 	const size_t pod_size = 100000;
@@ -340,5 +375,156 @@ int main(int argc, char* argv[]) {
 	}
 	cout << endl;
 
+	{
+		cout << "----- Test of move -----\n";
+		selfmadeSTL::vector<std::string> strings;
+		std::string long_string(100, 'x');
+		for (int i = 0; i < 1000; ++i) {
+			std::string value = long_string + std::to_string(i);
+			strings.push_back(std::move(value));
+		}
+		cout << "push_back(T&&): size = " << strings.size() << ", back() = " << strings.back().substr(100) << "[999]\n";
+
+		const char* data = strings.front().data();
+		selfmadeSTL::vector<std::string> moved(std::move(strings));
+		cout << "move constructor: " << (moved.front().data() == data) << ", " << strings.size() << "[true, 0]\n";
+
+		selfmadeSTL::vector<std::string> assigned;
+		assigned.push_back("a");
+		assigned = std::move(moved);
+		cout << "move assignment: " << (assigned.front().data() == data) << ", " << assigned.size() << "[true, 1000]\n";
+
+		// elements are moved to the new space
+		assigned.reserve(4096);
+		cout << "reserve: " << (assigned.front().data() == data) << "[true]\n";
+
+		// the inserted value is in the vector itself
+		assigned.shrink_to_fit();
+		assigned.insert(assigned.begin(), assigned.back());
+		assigned.insert(assigned.begin(), 2, assigned[1]);
+		cout << "insert itself: " << assigned[0].substr(100) << ' ' << assigned[2].substr(100)
+			<< ' ' << assigned.back().substr(100) << "[0 999 999]\n";
+		assigned.erase(assigned.begin());
+		cout << "erase: " << assigned.size() << ", " << assigned[2].substr(100) << "[1002, 0]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of emplace -----\n";
+		selfmadeSTL::vector<Record> records;
+		records.reserve(4);
+		Record::reset();
+		records.emplace_back(1, 1.5);
+		records.emplace_back(3, 3.5);
+		records.emplace(records.end(), 4, 4.5);
+		cout << "emplace_back: " << records.back().id << ", copies = " << Record::copies
+			<< ", moves = " << Record::moves << "[4, 0, 0]\n";
+		records.emplace(records.begin() + 1, 2, 2.5);
+		cout << "emplace: " << records[1].id << ' ' << records[2].id << ", copies = " << Record::copies << "[2 3, 0]\n";
+		// growth moves the records
+		records.emplace_back(5, 5.5);
+		cout << "emplace_back grow: " << records.size() << ' ' << records[4].id << ", copies = " << Record::copies << "[5 5, 0]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of relocation -----\n";
+		selfmadeSTL::vector<Relocated> relocated;
+		for (int i = 0; i < 100; ++i) {
+			relocated.push_back(Relocated(i));
+		}
+		Relocated::moves = 0;
+		relocated.insert(relocated.begin(), Relocated(-1));
+		relocated.insert(relocated.begin() + 50, 3, relocated[0]);
+		relocated.erase(relocated.begin() + 1, relocated.begin() + 11);
+		relocated.shrink_to_fit();
+		cout << "relocated: " << relocated.size() << ' ' << relocated[0].id << ' ' << *relocated[1].buffer
+			<< ' ' << *relocated[40].buffer << ' ' << relocated.back().id << "[94 -1 10 -1 99]\n";
+		// only the inserted value is moved, into a copy and then into place
+		cout << "moves: " << Relocated::moves << "[2]\n";
+
+		// a vector of vectors is relocated, the inner spaces stay
+		selfmadeSTL::vector<selfmadeSTL::vector<int>> nested(3, selfmadeSTL::vector<int>(4, 7));
+		const int* inner = &nested[0][0];
+		nested.insert(nested.begin(), selfmadeSTL::vector<int>(2, 1));
+		nested.erase(nested.begin() + 2);
+		cout << "nested: " << nested.size() << ' ' << nested[0].size() << ' ' << (&nested[1][0] == inner)
+			<< "[3 2 true]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of type traits -----\n";
+		cout << "Point: " << std::is_same<selfmadeSTL::__type_traits<Point>::is_POD_type, selfmadeSTL::__true_type>::value
+			<< ", Record: " << std::is_same<selfmadeSTL::__type_traits<Record>::is_POD_type, selfmadeSTL::__true_type>::value
+			<< "[true, false]\n";
+		selfmadeSTL::vector<Point> points(3, Point{ 1, 1.5 });
+		points.insert(points.begin() + 1, Point{ 2, 2.5 });
+		points.erase(points.begin());
+		cout << "points: " << points.size() << ' ' << points[0].x << ' ' << points[2].y << "[3 2 1.5]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of growth policy -----\n";
+		selfmadeSTL::vector<int, selfmadeSTL::allocator<int>, selfmadeSTL::growth_half> half;
+		cout << "growth_half:";
+		for (int i = 0; i < 10; ++i) {
+			half.push_back(i);
+			cout << ' ' << half.capacity();
+		}
+		cout << "[ 1 2 3 4 6 6 9 9 9 13]\n";
+
+		// a bulk insert grows geometrically too
+		selfmadeSTL::vector<int> doubled(100, 1);
+		doubled.insert(doubled.end(), (size_t)10, 2);
+		doubled.insert(doubled.end(), (size_t)300, 3);
+		cout << "bulk insert: " << doubled.size() << ' ' << doubled.capacity() << ' ' << doubled.back() << "[410 410 3]\n";
+		doubled.shrink_to_fit();
+		doubled.insert(doubled.begin(), doubled.begin(), doubled.begin() + 5);
+		cout << "bulk insert: " << doubled.capacity() << "[820]\n";
+
+		selfmadeSTL::vector<int, selfmadeSTL::allocator<int>, selfmadeSTL::page_growth<>> paged;
+		for (int i = 0; i < 2000; ++i) {
+			paged.push_back(i);
+		}
+		cout << "page_growth: " << paged.capacity() << ' ' << paged.capacity() * sizeof(int) % 4096 << "[2048 0]\n";
+	}
+	cout << endl;
+
+	{
+		cout << "----- Test of resize_for_overwrite and append -----\n";
+		selfmadeSTL::vector<double> samples(2, 0.5);
+		samples.resize_for_overwrite(6);
+		for (size_t i = 2; i < samples.size(); ++i) {
+			samples[i] = i * 1.5;
+		}
+		cout << "resize_for_overwrite: " << samples.size() << ' ' << samples[1] << ' ' << samples[5] << "[6 0.5 7.5]\n";
+		samples.resize_for_overwrite(3);
+		cout << "resize_for_overwrite: " << samples.size() << ' ' << samples.back() << "[3 3]\n";
+
+		// a reader that has fewer values than asked for
+		const double source[4] = { 1, 2, 3, 4 };
+		size_t written = samples.append(10, [&](double* first, size_t count) {
+			size_t n = count < 4 ? count : 4;
+			for (size_t i = 0; i < n; ++i) {
+				first[i] = source[i];
+			}
+			return n;
+		});
+		cout << "append: " << written << ' ' << samples.size() << ' ' << samples.back() << "[4 7 4]\n";
+
+		selfmadeSTL::vector<std::string> lines;
+		lines.push_back("head");
+		written = lines.append(3, [](std::string* first, size_t) {
+			first[0] = "line";
+			return (size_t)1;
+		});
+		cout << "append: " << written << ' ' << lines.size() << ' ' << lines.back() << ' ' << lines.capacity() << "[1 2 line 4]\n";
+		lines.resize_for_overwrite(4);
+		cout << "resize_for_overwrite: " << lines.size() << ' ' << lines[3].empty() << "[4 true]\n";
+	}
+	cout << endl;
+
 	return 0;
 }
\ No newline at end of file